@@ -0,0 +1,121 @@
+/*! @file CRC8Benchmark.ino
+
+@section CRC8Benchmark_intro_section Description
+
+This program measures the speed of the three implementations of the 1-Wire CRC in the DSFamily
+library. The CRC is checked on every scratchpad read and the compile-time setting DS_CRC8_METHOD
+chooses which implementation the library uses for that:\n
+"DS_CRC8_BITWISE" computes it one bit at a time and needs no table\n
+"DS_CRC8_NIBBLE"  computes it 4 bits at a time with a 16 byte table in program memory\n
+"DS_CRC8_TABLE"   computes it a byte at a time with a 256 byte table in program memory\n\n
+
+Each implementation checks the same 9 byte scratchpad a number of times and the processor cycles
+used per byte are shown, both in total and without the cost of the loop and the function call,
+which is measured separately. No 1-Wire devices need to be attached to run the program.
+
+@section CRC8Benchmarklicense License
+
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU
+General Public License as published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version. This program is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details. You should have
+received a copy of the GNU General Public License along with this program.  If not, see
+<http://www.gnu.org/licenses/>.
+
+@section CRC8Benchmarkauthor Author
+
+ Written by Arnd <Arnd@Zanduino.Com> at https://www.github.com/SV-Zanshin
+*/
+#include <DSFamily.h>  // DS Thermometers calls and methods
+/***************************************************************************************************
+** Declare all program constants                                                                  **
+***************************************************************************************************/
+const uint32_t SERIAL_BAUD_RATE = 115200;  ///< Serial communication baud rate
+const uint16_t ITERATIONS       = 2000;    ///< Scratchpads checked by each implementation
+/** @brief  Scratchpad of a DS18B20 after power-on, including its CRC */
+const uint8_t SCRATCHPAD[9] = {0x50, 0x05, 0x4B, 0x46, 0x7F, 0xFF, 0x0C, 0x10, 0x1C};
+/***************************************************************************************************
+** Declare global variables                                                                       **
+***************************************************************************************************/
+volatile uint8_t result;  ///< Keeps the compiler from removing the computation
+
+__attribute__((noinline)) uint8_t emptyStep(const uint8_t crc, const uint8_t data) {
+  /*!
+    @brief    Stand-in for a CRC function, used to measure the cost of the loop and the call
+    @param[in] crc  Running value
+    @param[in] data Next byte
+    @return   Running value including the byte
+  */
+  return (crc ^ data);
+}  // of method emptyStep()
+
+template <uint8_t (*step)(uint8_t, uint8_t)>
+uint32_t measure() {
+  /*!
+    @brief    Check the scratchpad ITERATIONS times with one of the CRC functions
+    @return   Elapsed microseconds
+  */
+  uint8_t  crc   = 0;
+  uint32_t start = micros();
+  for (uint16_t n = 0; n < ITERATIONS; n++) {
+    crc = 0;
+    for (uint8_t i = 0; i < 9; i++) crc = step(crc, SCRATCHPAD[i]);
+    result = crc;
+  }  // of for-next each iteration
+  return (micros() - start);
+}  // of method measure()
+
+void report(const char *name, const uint32_t elapsed, const uint32_t baseline) {
+  /*!
+    @brief    Show the cycles per byte of one implementation in tenths of a cycle
+    @param[in] name Name of the implementation
+    @param[in] elapsed Microseconds taken by the implementation
+    @param[in] baseline Microseconds taken by the baseline
+  */
+  const uint32_t bytes = (uint32_t)ITERATIONS * 9;
+  uint32_t       total = elapsed * (F_CPU / 100000) / bytes;               // Tenths of a cycle
+  uint32_t       net   = (elapsed - baseline) * (F_CPU / 100000) / bytes;  // without the call
+  Serial.print(name);
+  Serial.print(total / 10);
+  Serial.print('.');
+  Serial.print(total % 10);
+  Serial.print(" cycles/byte, ");
+  Serial.print(net / 10);
+  Serial.print('.');
+  Serial.print(net % 10);
+  Serial.print(" without loop and call, CRC check ");
+  Serial.print(result == 0 ? "passed\n" : "FAILED\n");
+}  // of method report()
+
+void setup() {
+  /*!
+    @brief    Arduino method called once at startup to initialize the system
+    @details  This is an Arduino IDE method which is called first upon boot or restart. It is only
+              called one time and then control goes to the main "loop()" method, from which control
+              never returns
+    @return   void
+  */
+  Serial.begin(SERIAL_BAUD_RATE);  // initiate serial I/O communications
+#ifdef __AVR_ATmega32U4__  // If this is a 32U4 processor, then wait 3 seconds to initialize USB
+  delay(3000);
+#endif
+  Serial.print("\n\nDSFamily CRC8 benchmark program\n- Library compiled with ");
+  Serial.print(DS_CRC8_METHOD == DS_CRC8_TABLE    ? "DS_CRC8_TABLE\n"
+               : DS_CRC8_METHOD == DS_CRC8_NIBBLE ? "DS_CRC8_NIBBLE\n"
+                                                  : "DS_CRC8_BITWISE\n");
+}  // of method setup()
+
+void loop() {
+  /*!
+    @brief    Arduino method for the main program loop
+    @details  Runs the benchmark of each implementation every 5 seconds
+    @return   void
+  */
+  uint32_t base = measure<emptyStep>();
+  report("- Bitwise: ", measure<DSFamily_Class::crc8Bitwise>(), base);
+  report("- Nibble:  ", measure<DSFamily_Class::crc8Nibble>(), base);
+  report("- Table:   ", measure<DSFamily_Class::crc8Table>(), base);
+  Serial.print("- Waiting 5 seconds...\n\n");
+  delay(5000);
+}  // of method loop()
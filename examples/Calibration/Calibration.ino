@@ -17,10 +17,10 @@ they read slightly different temperatures. The calibration process measures the
 of the different devices and then assumes that the average value of all readings for all
 thermometers is the correct value and then an offset to that ideal temperature is computed.\n\n
 
-Each DS-Family thermometer has 2 user bytes available for reading/writing. These two bytes can be
-used for high and low temperature alarms; but these are used for calibration purposes by this
-library. In order to prevent errors when one or both bytes are modified, the exclusive OR of the two
-values must be 0xFF in order for a calibration offset to be applied.
+The offset of each thermometer is stored next to its ROM address in the EEPROM table of the library,
+so the 2 user bytes of the devices remain available for the high and low temperature alarms. Older
+versions of the library stored the offset in those 2 user bytes, such an offset is still applied
+until the device is calibrated again.
 
 @section Calibrationlicense License
 
@@ -57,7 +57,7 @@ const uint8_t  SPRINTF_BUFFER_SIZE{64};     ///< Maximum single sprintf() buffer
 /***************************************************************************************************
 ** Declare global variables and instantiate classes                                               **
 ***************************************************************************************************/
-uint8_t        thermometers = 0;             ///< The number of devices found
+DSDeviceNumber thermometers = 0;             ///< The number of devices found
 char           buffer[SPRINTF_BUFFER_SIZE];  ///< buffer for sprintf() calls
 uint8_t        ROMBuffer[8];                 ///< Holds unique address of device
 DSFamily_Class DSFamily(ONE_WIRE_PIN, 128);  ///< Start DSFamily, reserve 128 Bytes
@@ -87,18 +87,10 @@ void loop() {
               repeating.
     @return   void
   */
-  int64_t statsCAL[32], statsRAW[32];
-  int64_t avgCAL, avgRAW;
-  float   stdDevCAL, stdDevRAW;
-  for (uint8_t i = 0; i < 32; i++)  // Simple but slow method to zero out arrays
-  {
-    statsCAL[i] = 0;
-    statsRAW[i] = 0;
-  }  // of for-next loop to clear array
-  avgCAL    = 0;
-  avgRAW    = 0;
-  stdDevCAL = 0;
-  stdDevRAW = 0;  // Reset values to zero
+  float avgCAL    = 0;  // Running mean of the device averages, calibrated and raw
+  float avgRAW    = 0;
+  float stdDevCAL = 0;  // Running sums of the squared deviations from that mean
+  float stdDevRAW = 0;
   Serial.print("- Assuming thermometers are at the same temperature.\n");
   Serial.print("- Running Calibration for ");
   Serial.print(CALIBRATION_ITERATIONS);
@@ -109,7 +101,7 @@ void loop() {
   Serial.print("\n- Finished calibrating offsets as follows:\n\n");
   Serial.print("## Hex ROM Address  Raw  Off Corr Temp C \n");
   Serial.print("== ================ ==== === ==== =======\n");
-  for (uint8_t i = 0; i < DSFamily.ThermometersFound; i++)  // loop for each thermometer found
+  for (DSDeviceNumber i = 0; i < DSFamily.ThermometersFound; i++)  // loop for each thermometer
   {
     DSFamily.GetDeviceROM(i, ROMBuffer);  // Read the unique ROM Address
     sprintf(buffer, "%02d %02X%02X%02X%02X%02X%02X%02X%02X %04d %3d %04d ", i, ROMBuffer[0],
@@ -127,27 +119,21 @@ void loop() {
   Serial.print(" iterations and ");
   Serial.print(CALIBRATION_ITERATIONS * DSFamily.ConversionMillis / 1000);
   Serial.print(" seconds. Please Wait...");
-  for (uint8_t j = 0; j < CALIBRATION_ITERATIONS; j++)  // loop the number of iterations
-  {
-    for (uint8_t i = 0; i < thermometers; i++) {
-      statsCAL[i] += DSFamily.ReadDeviceTemp(i);        // compute calibrated statistics
-      statsRAW[i] += DSFamily.ReadDeviceTemp(i, true);  // compute raw statistics
-    }                                                   // of for-next each thermometer
-  }                                                     // of for-next each iteration
-  for (uint8_t i = 0; i < thermometers; i++) {
-    // Sum up the raw and calibrated data in order to compute the averages for both
-    avgCAL += statsCAL[i];
-    avgRAW += statsRAW[i];
-  }                                                         // of for-next compute sums
-  avgCAL = avgCAL / CALIBRATION_ITERATIONS / thermometers;  // Store the average calibrated
-  avgRAW = avgRAW / CALIBRATION_ITERATIONS / thermometers;  // Store the average raw value
-  for (uint8_t i = 0; i < DSFamily.ThermometersFound; i++) {
-    stdDevCAL +=
-        sq((statsCAL[i] / CALIBRATION_ITERATIONS) - avgCAL);  // Sum up the std deviation values
-    stdDevRAW +=
-        sq((statsRAW[i] / CALIBRATION_ITERATIONS) - avgRAW);  // Sum up the std deviation values
-  }                                                           // of for-next all thermometers
-  stdDevCAL = stdDevCAL / thermometers;
+  for (DSDeviceNumber i = 0; i < thermometers; i++) {
+    int32_t sumCAL = 0, sumRAW = 0;  // Readings of this device, so no per-device arrays are needed
+    for (uint8_t j = 0; j < CALIBRATION_ITERATIONS; j++)  // loop the number of iterations
+    {
+      sumCAL += DSFamily.ReadDeviceTemp(i);        // compute calibrated statistics
+      sumRAW += DSFamily.ReadDeviceTemp(i, true);  // compute raw statistics
+    }                                              // of for-next each iteration
+    float deltaCAL = (float)sumCAL / CALIBRATION_ITERATIONS - avgCAL;  // Device average less
+    float deltaRAW = (float)sumRAW / CALIBRATION_ITERATIONS - avgRAW;  // the running mean
+    avgCAL += deltaCAL / (i + 1);                                      // Update the means
+    avgRAW += deltaRAW / (i + 1);
+    stdDevCAL += deltaCAL * ((float)sumCAL / CALIBRATION_ITERATIONS - avgCAL);  // and the sums
+    stdDevRAW += deltaRAW * ((float)sumRAW / CALIBRATION_ITERATIONS - avgRAW);
+  }  // of for-next each thermometer
+  stdDevCAL = stdDevCAL / thermometers;  // Variance of the device averages
   stdDevRAW = stdDevRAW / thermometers;
   Serial.print("\n- Variance/StdDev raw    : ");
   Serial.print(stdDevRAW, 3);
@@ -86,13 +86,14 @@ void loop() {
   Serial.print("- Setting all thermometers to ");
   Serial.print(precision);
   Serial.print(" bits precision\n");
-  for (uint8_t i = 0; i < DSFamily.ThermometersFound; i++)
-    DSFamily.SetDeviceResolution(i, precision);  // Set resolution to current value
-  DSFamily.DeviceStartConvert();                 // Start conversion on all devices
-  Serial.print("- Starting measurement (waiting ");
+  DSFamily.SetDeviceResolution(DS_ALL_DEVICES, precision);  // Set all devices with one NV write
+  DSFamily.DeviceStartConvert();                            // Start conversion on all devices
+  Serial.print("- Starting measurement (up to ");
   Serial.print(DSFamily.ConversionMillis);
   Serial.print("ms).\n");
-  delay(DSFamily.ConversionMillis);
+  while (DSFamily.poll() == DS_CONVERSION_ACTIVE) {
+    // Other work can be done here while the conversion is running
+  }  // of while conversion is active
   Serial.print("- Minimum temperature is ");
   temperature = DSFamily.MinTemperature();  // retrieve the Minimum temperature
   Serial.print(temperature);
@@ -0,0 +1,405 @@
+/*! @file HostTests.cpp
+
+@section HostTests_intro_section Description
+
+This host program runs the library against the simulated bus of DSFamily_Sim.h and checks the
+results, so no hardware is needed. It prints one line per failed check and a summary, and returns
+a non-zero exit code if any check failed. The following is tested:\n
+"scan"     ScanForDevices() of a mixed bus, the readings, and ScanForDevices(true) reusing the table
+           without any NV write, falling back to the search when a stored device is missing, and
+           SetDeviceAlarm() not broadcasting COPY SCRATCHPAD to the other device on the bus\n
+"rescan"   RescanDevices() and VerifyDevices() with removed devices, which keep their number, groups
+           and calibration as tombstones, while the addresses of all other devices stay intact\n
+"renumber" ScanForDevices() of a bus with a new device sorting before the others, where the groups,
+           calibration and gain follow each device to its new number, and moving an offset which
+           an older version stored in TH and TL into the table\n
+"queue"    QueueRequest() and ServiceQueue(), only when DS_QUEUE_SIZE is defined\n
+"sampler"  StartSampler(), ServiceSampler() and ReadSample(), only when DS_SAMPLER_SIZE is defined\n
+"adaptive" SetAdaptiveResolution() never storing a lowered resolution in NV memory, only when
+           DS_ADAPTIVE_RESOLUTION is defined\n\n
+
+The program is built from the library folder, once for each set of options to be tested, e.g.:\n
+g++ -std=c++11 -O2 -DDS_ROM_CACHE_SIZE=4 -DDS_QUEUE_SIZE=8 -DDS_SAMPLER_SIZE=16 -Isrc
+src/DSFamily.cpp src/DSFamily_Host.cpp src/DSFamily_Sim.cpp extras/HostTests/HostTests.cpp
+-o HostTests\n\n
+
+The "Host tests" workflow in .github/workflows/ci-host-tests.yml builds and runs it with the ROM
+cache off, smaller than the bus and large enough for the whole bus, and with wide device numbers.
+
+@section HostTestslicense License
+
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU
+General Public License as published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version. This program is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details. You should have
+received a copy of the GNU General Public License along with this program.  If not, see
+<http://www.gnu.org/licenses/>.
+
+@section HostTestsauthor Author
+
+ Written by Arnd <Arnd@Zanduino.Com> at https://www.github.com/SV-Zanshin
+*/
+#include <stdio.h>
+
+#include "DSFamily_Sim.h"  // Simulated 1-Wire network
+/***************************************************************************************************
+** Declare all program constants and global variables                                            **
+***************************************************************************************************/
+const uint32_t SERIAL_BASE{0x2000};  ///< First serial number
+uint16_t       checks{0};            ///< Number of checks done
+uint16_t       failures{0};          ///< Number of checks which failed
+
+/** @brief  Count a check and report it if the condition doesn't hold */
+#define CHECK(condition) check((condition), #condition, __LINE__)
+
+void check(const bool passed, const char *text, const int line) {
+  /*!
+    @brief    Count a check and print it if it failed
+    @param[in] passed Result of the check
+    @param[in] text   Source text of the checked condition
+    @param[in] line   Source line of the check
+  */
+  checks++;
+  if (!passed) {
+    failures++;
+    printf("  FAILED line %d: %s\n", line, text);
+  }  // if-then check failed
+}  // of method check()
+void clearEeprom() {
+  /*!
+    @brief    Erase the emulated EEPROM so that each test starts without a ROM table
+  */
+  for (uint32_t a = 0; a <= E2END; a++) EEPROM.update(a, 0xFF);
+}  // of method clearEeprom()
+DSDeviceNumber deviceOf(DSFamily_Sim &bus, const uint16_t index) {
+  /*!
+    @brief    Return the device number of a simulated device, which follows the search order
+    @param[in] bus   Simulated bus
+    @param[in] index Index returned by addDevice()
+    @return   Device number, DS_ALL_DEVICES if the device isn't in the ROM table
+  */
+  uint8_t rom[8];
+  for (DSDeviceNumber i = 0; i < bus.ThermometersFound; i++) {
+    bus.GetDeviceROM(i, rom);
+    if (memcmp(rom, bus.device(index).rom, 8) == 0) return (i);
+  }  // for-next each stored device
+  return (DS_ALL_DEVICES);
+}  // of method deviceOf()
+uint16_t nvWrites(DSFamily_Sim &bus) {
+  /*!
+    @brief    Return the number of COPY SCRATCHPAD commands received by all simulated devices
+    @param[in] bus Simulated bus
+    @return   Sum of the NV writes
+  */
+  uint16_t writes = 0;
+  for (uint16_t i = 0; i < bus.deviceCount(); i++) writes += bus.device(i).nvWrites;
+  return (writes);
+}  // of method nvWrites()
+void testScan() {
+  /*!
+    @brief    Scan a mixed bus, read it, and warm start from the stored table
+  */
+  printf("scan\n");
+  clearEeprom();
+  DSFamily_Sim bus;
+  for (uint16_t i = 0; i < 6; i++) {
+    bus.setTemperature(bus.addDevice(0x28, SERIAL_BASE + i), 320 + i);
+  }  // for-next each DS18B20
+  bus.setTemperature(bus.addDevice(0x22, SERIAL_BASE + 6), 400);  // DS1822
+  bus.setTemperature(bus.addDevice(0x10, SERIAL_BASE + 7), 480);  // DS18S20
+  bus.addDevice(0x01, SERIAL_BASE + 8);                           // DS2401 serial number
+  CHECK(bus.ScanForDevices() == 8);
+  for (uint16_t i = 0; i < 8; i++) CHECK(deviceOf(bus, i) < 8);
+  CHECK(deviceOf(bus, 8) == DS_ALL_DEVICES);
+  bus.DeviceStartConvert(DS_ALL_DEVICES, true);
+  for (uint16_t i = 0; i < 7; i++) {
+    CHECK(bus.ReadDeviceTemp(deviceOf(bus, i)) == bus.device(i).temperature);
+  }  // for-next each device with 1/16°C units
+  CHECK(bus.ReadDeviceTemp(deviceOf(bus, 7)) != DS_BAD_TEMPERATURE);
+  DSDeviceNumber numbers[8];
+  for (uint16_t i = 0; i < 8; i++) numbers[i] = deviceOf(bus, i);
+  uint16_t writes = nvWrites(bus);
+  uint32_t start  = micros();
+  CHECK(bus.ScanForDevices(true) == 8);
+  uint32_t warm = micros() - start;
+  CHECK(nvWrites(bus) == writes);  // Stored devices keep their resolution
+  for (uint16_t i = 0; i < 8; i++) CHECK(deviceOf(bus, i) == numbers[i]);
+  bus.SetDeviceAlarm(DS_ALL_DEVICES, 5, 40);  // No broadcast copy with the DS2401 on the bus
+  CHECK(bus.device(8).nvWrites == 0);
+  for (uint16_t i = 0; i < 8; i++) CHECK((int8_t)bus.device(i).nv[0] == 40);
+  start = micros();
+  bus.ScanForDevices();
+  CHECK(warm < micros() - start);  // Cheaper than the search
+  bus.setPresent(3, false);
+  CHECK(bus.ScanForDevices(true) == 7);  // Falls back to the full search
+  CHECK(deviceOf(bus, 3) == DS_ALL_DEVICES);
+}  // of method testScan()
+void testRescan() {
+  /*!
+    @brief    Remove, add and return devices with RescanDevices() and VerifyDevices()
+  */
+  printf("rescan\n");
+  clearEeprom();
+  DSFamily_Sim bus;
+  uint8_t      before[10][8], rom[8];
+  for (uint16_t i = 0; i < 10; i++) {
+    bus.setTemperature(bus.addDevice(0x28, SERIAL_BASE + i * 11), 320 + i);
+  }  // for-next each device
+  CHECK(bus.ScanForDevices() == 10);
+  for (DSDeviceNumber d = 0; d < 10; d++) {
+    bus.SetDeviceGroups(d, 1 << (d & 7));
+    bus.SetDeviceCalibration(d, (int8_t)d);
+    bus.GetDeviceROM(d, before[d]);
+  }  // for-next each device
+  CHECK(bus.RescanDevices() == 0);
+  const DSDeviceNumber number = 0;  // Device which is removed
+  uint16_t             gone   = 0;  // and its simulated device
+  while (deviceOf(bus, gone) != number) gone++;
+  for (DSDeviceNumber d = 9; d > 5; d--) bus.ReadDeviceTemp(d);  // Uses other cache entries
+  bus.setPresent(gone, false);
+  CHECK(bus.VerifyDevices() == 1);
+  CHECK(bus.DeviceRemoved(number));
+  for (DSDeviceNumber d = 0; d < 10; d++) {
+    bus.GetDeviceROM(d, rom);
+    CHECK(memcmp(rom, before[d], 7) == 0);  // The CRC byte marks a tombstone
+  }  // for-next each device
+  bus.DeviceStartConvert(DS_ALL_DEVICES, true);
+  CHECK(bus.ReadDeviceTemp(number) == DS_BAD_TEMPERATURE);
+  CHECK(bus.TakeSnapshot() == 9);
+  uint16_t added = bus.addDevice(0x28, SERIAL_BASE - 1);  // New device
+  bus.setTemperature(added, 500);
+  CHECK(bus.RescanDevices() == 1);
+  CHECK(bus.ThermometersFound == 11);
+  CHECK(deviceOf(bus, added) == 10);  // Appended, existing numbers stay
+  CHECK(bus.DeviceRemoved(number));
+  for (DSDeviceNumber d = 0; d < 10; d++) {
+    CHECK(bus.GetDeviceGroups(d) == 1 << (d & 7));
+    CHECK(bus.GetDeviceCalibration(d) == (int8_t)d);
+  }  // for-next each old device
+  bus.DeviceStartConvert(DS_ALL_DEVICES, true);
+  CHECK(bus.ReadDeviceTemp(10) == 500);
+  bus.setPresent(gone, true);
+  CHECK(bus.RescanDevices() == 1);
+  CHECK(!bus.DeviceRemoved(number));
+  CHECK(deviceOf(bus, gone) == number);
+  for (DSDeviceNumber d = 0; d < 10; d++) {
+    bus.GetDeviceROM(d, rom);
+    CHECK(memcmp(rom, before[d], 8) == 0);
+  }  // for-next each device
+  bus.setPresent(gone, false);
+  bus.RescanDevices();
+  CHECK(bus.ScanForDevices(true) == 11);  // The tombstone survives a warm start
+  CHECK(bus.DeviceRemoved(number));
+  CHECK(bus.GetDeviceGroups(number) == 1 << (number & 7));
+  for (uint16_t i = 0; i < bus.deviceCount(); i++) bus.setPresent(i, false);
+  CHECK(bus.RescanDevices() == 0);  // A bus without presence pulse leaves the table alone
+  CHECK(bus.ThermometersFound == 11);
+  CHECK(!bus.DeviceRemoved(number + 1));
+}  // of method testRescan()
+void testRenumber() {
+  /*!
+    @brief    Keep groups, calibration and gain with their devices when a new scan renumbers them
+  */
+  printf("renumber\n");
+  clearEeprom();
+  DSFamily_Sim bus;
+  for (uint16_t i = 0; i < 4; i++) {
+    bus.setTemperature(bus.addDevice(0x28, SERIAL_BASE + i * 11), 320 + i);
+  }  // for-next each device
+  bus.device(0).scratchpad[2] = bus.device(0).nv[0] = 3;     // Offset of an older version in TH
+  bus.device(0).scratchpad[3] = bus.device(0).nv[1] = 0xFC;  // and its inverse in TL
+  bus.device(0).scratchpad[8] = bus.crc8(bus.device(0).scratchpad, 8);
+  CHECK(bus.ScanForDevices() == 4);
+  CHECK(bus.GetDeviceCalibration(deviceOf(bus, 0)) == 3);  // Moved into the table
+  for (uint16_t i = 0; i < 4; i++) {
+    bus.SetDeviceGroups(deviceOf(bus, i), 1 << i);
+    bus.SetDeviceCalibration(deviceOf(bus, i), (int16_t)(i * 20 + 1), (int16_t)(i * 300 + 7));
+  }  // for-next each device
+  uint16_t added = bus.addDevice(0x28, 0);  // The search finds it first
+  CHECK(bus.ScanForDevices() == 5);
+  CHECK(deviceOf(bus, added) == 0);  // All old devices have a new number
+  CHECK(bus.GetDeviceGroups(0) == 0);
+  CHECK(bus.GetDeviceOffset(0) == 0);
+  CHECK(bus.GetDeviceGain(0) == 0);
+  for (uint16_t i = 0; i < 4; i++) {
+    CHECK(bus.GetDeviceGroups(deviceOf(bus, i)) == 1 << i);
+    CHECK(bus.GetDeviceOffset(deviceOf(bus, i)) == i * 20 + 1);
+    CHECK(bus.GetDeviceGain(deviceOf(bus, i)) == i * 300 + 7);
+  }  // for-next each old device
+  bus.setPresent(1, false);
+  CHECK(bus.ScanForDevices() == 4);  // The entry of the missing device is kept behind the others
+  CHECK(deviceOf(bus, 1) == DS_ALL_DEVICES);
+  bus.setPresent(1, true);
+  CHECK(bus.ScanForDevices() == 5);  // and found again
+  for (uint16_t i = 0; i < 4; i++) {
+    CHECK(bus.GetDeviceGroups(deviceOf(bus, i)) == 1 << i);
+    CHECK(bus.GetDeviceOffset(deviceOf(bus, i)) == i * 20 + 1);
+  }  // for-next each old device
+  CHECK(bus.GetDeviceGroups(deviceOf(bus, added)) == 0);
+}  // of method testRenumber()
+#if DS_QUEUE_SIZE > 0
+DSRequest done[16];      ///< Requests reported by the callback
+uint8_t   doneCount{0};  ///< Number of reported requests
+
+void requestDone(const DSRequest &request) {
+  /*!
+    @brief    Callback of the queue, remembers each request done
+    @param[in] request The request which has been run
+  */
+  if (doneCount < 16) done[doneCount++] = request;
+}  // of method requestDone()
+void runQueue(DSFamily_Sim &bus) {
+  /*!
+    @brief    Service the queue until it is empty
+    @param[in] bus Simulated bus
+  */
+  for (uint16_t i = 0; i < 10000 && bus.RequestsQueued(); i++) {
+    bus.ServiceQueue();
+    delay(1);
+  }  // for-next until the queue is empty
+}  // of method runQueue()
+void testQueue() {
+  /*!
+    @brief    Merge, order and run queued requests
+  */
+  printf("queue\n");
+  clearEeprom();
+  DSFamily_Sim bus;
+  for (uint16_t i = 0; i < 4; i++) bus.setTemperature(bus.addDevice(0x28, SERIAL_BASE + i), 320);
+  bus.ScanForDevices();
+  for (uint16_t i = 0; i < 4; i++) bus.setTemperature(i, 320 + deviceOf(bus, i) * 16);
+  bus.SetRequestCallback(requestDone);
+  doneCount = 0;
+  bus.QueueRequest(DS_REQUEST_CONVERT, 0);
+  bus.QueueRequest(DS_REQUEST_CONVERT, 1);
+  CHECK(bus.RequestsQueued() == 1);  // Merged into one conversion
+  bus.QueueRequest(DS_REQUEST_READ, 0);
+  bus.QueueRequest(DS_REQUEST_READ, 0);
+  bus.QueueRequest(DS_REQUEST_READ, 1, 0, DS_PRIORITY_URGENT);
+  CHECK(bus.RequestsQueued() == 3);  // Duplicate read dropped
+  runQueue(bus);
+  CHECK(doneCount == 3);
+  CHECK(done[0].type == DS_REQUEST_CONVERT);
+  CHECK(done[1].type == DS_REQUEST_READ && done[1].device == 1 && done[1].value == 336);
+  CHECK(done[2].type == DS_REQUEST_READ && done[2].device == 0 && done[2].value == 320);
+  doneCount = 0;
+  bus.QueueRequest(DS_REQUEST_RESOLUTION, DS_ALL_DEVICES, 10, DS_PRIORITY_BACKGROUND);
+  bus.QueueRequest(DS_REQUEST_ALARM, 2, (int16_t)(10 | (30 << 8)), DS_PRIORITY_BACKGROUND);
+  bus.QueueRequest(DS_REQUEST_ALARM, 2, (int16_t)(15 | (35 << 8)), DS_PRIORITY_BACKGROUND);
+  bus.QueueRequest(DS_REQUEST_READ, 3, 0, DS_PRIORITY_URGENT);
+  CHECK(bus.RequestsQueued() == 3);  // Newer alarm limits replace the queued ones
+  runQueue(bus);
+  CHECK(doneCount == 3);
+  CHECK(done[0].type == DS_REQUEST_READ && done[0].value == 368);  // Overtakes the settings
+  CHECK(bus.GetDeviceResolution(1) == 10);
+  CHECK(bus.ConversionMillis == 188);
+  CHECK(!bus.QueueRequest(DS_REQUEST_READ, DS_ALL_DEVICES));
+  CHECK(!bus.QueueRequest(DS_REQUEST_READ, 9));
+  CHECK(!bus.QueueRequest(7, 0));
+}  // of method testQueue()
+#endif
+#if DS_SAMPLER_SIZE > 0
+void testSampler() {
+  /*!
+    @brief    Sample all devices in the background and drain the ring buffer
+  */
+  printf("sampler\n");
+  clearEeprom();
+  DSFamily_Sim bus;
+  for (uint16_t i = 0; i < 6; i++) bus.setTemperature(bus.addDevice(0x28, SERIAL_BASE + i), 320);
+  bus.ScanForDevices();
+  for (uint16_t i = 0; i < 6; i++) bus.setTemperature(i, 320 + deviceOf(bus, i));
+  DSSample sample;
+  uint16_t got = 0, bad = 0, order = 0;
+  int16_t  previous = -1;
+  bus.StartSampler(1000);
+  uint32_t start = millis();
+  while (millis() - start < 5000) {
+    bus.ServiceSampler();
+    while (bus.ReadSample(sample)) {
+      got++;
+      if (sample.temperature != 320 + sample.device) bad++;
+      if (sample.device != (previous + 1) % 6) order++;
+      previous = sample.device;
+    }  // of while readings available
+    delay(1);
+  }  // of while sampling
+  bus.StartSampler(0);
+  CHECK(got >= 24);  // At least 4 sweeps of all devices
+  CHECK(bad == 0);
+  CHECK(order == 0);
+  CHECK(bus.SamplesDropped() == 0);
+  bus.StartSampler(100);  // The readings aren't taken, so the buffer fills up
+  start = millis();
+  while (millis() - start < 5000) {
+    bus.ServiceSampler();
+    delay(1);
+  }  // of while sampling
+  bus.StartSampler(0);
+  CHECK(bus.SamplesAvailable() == DS_SAMPLER_SIZE);
+  CHECK(bus.SamplesDropped() > 0);
+}  // of method testSampler()
+#endif
+#if DS_ADAPTIVE_RESOLUTION > 0
+void testAdaptive() {
+  /*!
+    @brief    Lower the resolution of changing devices without storing it in NV memory
+  */
+  printf("adaptive\n");
+  clearEeprom();
+  DSFamily_Sim bus;
+  uint16_t     count = DS_ADAPTIVE_RESOLUTION < 4 ? DS_ADAPTIVE_RESOLUTION : 4;
+  for (uint16_t i = 0; i < count; i++) {
+    bus.setTemperature(bus.addDevice(0x28, SERIAL_BASE + i), 320);
+  }  // for-next each device
+  bus.ScanForDevices();
+  bus.SetDeviceResolution(DS_ALL_DEVICES, 11);
+  bus.SetAdaptiveResolution(96, 24, 9, 3);  // Fast is 6°C/min, calm up to 1.5°C/min
+  int16_t temperature = 320;
+  for (uint8_t sweep = 0; sweep < 4; sweep++) {
+    if (sweep) temperature += 48;  // 3°C per sweep
+    for (uint16_t i = 0; i < count; i++) bus.setTemperature(i, temperature);
+    bus.DeviceStartConvert();
+    bus.TakeSnapshot();
+  }  // for-next each fast sweep
+  for (uint16_t i = 0; i < count; i++) {
+    CHECK(((bus.device(i).scratchpad[4] >> 5) & 3) + 9 == 9);
+  }  // for-next each device
+  bus.SetDeviceAlarm(DS_ALL_DEVICES, -10, 60);  // Broadcast COPY SCRATCHPAD
+  for (uint16_t i = 0; i < count; i++) {
+    CHECK(((bus.device(i).nv[2] >> 5) & 3) + 9 == 11);
+    CHECK((int8_t)bus.device(i).nv[0] == 60);
+    CHECK(((bus.device(i).scratchpad[4] >> 5) & 3) + 9 == 9);
+  }  // for-next each device
+  for (uint8_t sweep = 0; sweep < 5; sweep++) {
+    bus.DeviceStartConvert();
+    bus.TakeSnapshot();
+  }  // for-next each calm sweep
+  for (uint16_t i = 0; i < count; i++) {
+    CHECK(((bus.device(i).scratchpad[4] >> 5) & 3) + 9 == 11);
+  }  // for-next each device
+}  // of method testAdaptive()
+#endif
+int main() {
+  /*!
+    @brief    Run all tests which the options allow and print a summary
+    @return   0 if all checks passed, 1 otherwise
+  */
+  printf("DS_MAX_DEVICES %u, DS_ROM_CACHE_SIZE %u\n", (unsigned)DS_MAX_DEVICES,
+         (unsigned)DS_ROM_CACHE_SIZE);
+  testScan();
+  testRescan();
+  testRenumber();
+#if DS_QUEUE_SIZE > 0
+  testQueue();
+#endif
+#if DS_SAMPLER_SIZE > 0
+  testSampler();
+#endif
+#if DS_ADAPTIVE_RESOLUTION > 0
+  testAdaptive();
+#endif
+  printf("%u checks, %u failed\n", checks, failures);
+  return (failures ? 1 : 0);
+}  // of method main()
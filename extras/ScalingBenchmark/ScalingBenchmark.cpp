@@ -0,0 +1,86 @@
+/*! @file ScalingBenchmark.cpp
+
+@section ScalingBenchmark_intro_section Description
+
+This host program measures how the time to search a 1-Wire bus and to read all of its devices grows
+with the number of devices. It runs on the simulated bus of DSFamily_Sim.h, so no hardware is needed
+and the times shown are those of the virtual clock, i.e. the 1-Wire slot times the real bus would
+take. For each device count the following is shown:\n
+"search"  ScanForDevices() on an empty ROM table, i.e. a full SEARCH ROM of the bus\n
+"warm"    ScanForDevices(true) with the table stored by the search, which only verifies it\n
+"sweep"   TakeSnapshot() after a conversion, one scratchpad read per device\n\n
+
+Bus sizes beyond 254 devices need the wide device numbers and more EEPROM than the default 4KB of
+the host emulation, so the program is built from the library folder with:\n
+g++ -std=c++11 -O2 -DDS_MAX_DEVICES=1000 -DE2END=16383 -Isrc src/DSFamily.cpp src/DSFamily_Host.cpp
+src/DSFamily_Sim.cpp extras/ScalingBenchmark/ScalingBenchmark.cpp -o ScalingBenchmark\n\n
+
+Without those two settings only the bus sizes up to the default DS_MAX_DEVICES of 254 are measured.
+
+@section ScalingBenchmarklicense License
+
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU
+General Public License as published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version. This program is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details. You should have
+received a copy of the GNU General Public License along with this program.  If not, see
+<http://www.gnu.org/licenses/>.
+
+@section ScalingBenchmarkauthor Author
+
+ Written by Arnd <Arnd@Zanduino.Com> at https://www.github.com/SV-Zanshin
+*/
+#include <stdio.h>
+
+#include "DSFamily_Sim.h"  // Simulated 1-Wire network
+/***************************************************************************************************
+** Declare all program constants                                                                  **
+***************************************************************************************************/
+const uint16_t DEVICE_COUNTS[] = {8, 16, 32, 64, 128, 256, 512, 1000};  ///< Bus sizes measured
+const uint32_t SERIAL_BASE{0x1000};                                     ///< First serial number
+
+uint32_t measure(DSFamily_Sim &bus, const uint8_t step) {
+  /*!
+    @brief    Run one step of the benchmark on the bus and return its virtual time
+    @param[in] bus  Simulated bus with all devices attached
+    @param[in] step 0 for the search, 1 for the warm start and 2 for the sweep
+    @return   Elapsed microseconds of the virtual clock
+  */
+  if (step == 2) bus.DeviceStartConvert(DS_ALL_DEVICES, true);  // Readings for the sweep
+  uint64_t start = DSHostMicros();
+  switch (step) {
+    case 0: bus.ScanForDevices(); break;
+    case 1: bus.ScanForDevices(true); break;
+    default: bus.TakeSnapshot();
+  }  // of switch the step
+  return (DSHostMicros() - start);
+}  // of method measure()
+
+int main() {
+  /*!
+    @brief    Measure each bus size in turn and print one line per size
+    @return   0
+  */
+  printf("DS_MAX_DEVICES %u, EEPROM %u bytes\n", (unsigned)DS_MAX_DEVICES, (unsigned)E2END + 1);
+  printf(" devices  found     search ms       warm ms      sweep ms  sweep us/device\n");
+  for (uint16_t count : DEVICE_COUNTS) {
+    if (count > DS_MAX_DEVICES) break;
+    for (uint32_t a = 0; a <= E2END; a++) EEPROM.update(a, 0xFF);  // Start with an empty table
+    DSFamily_Sim bus;
+    for (uint16_t i = 0; i < count; i++) {
+      bus.setTemperature(bus.addDevice(0x28, SERIAL_BASE + i), 20 * 16 + i % 64);
+    }  // for-next each device
+    int16_t *snapshot = new int16_t[count];  // Keep every reading of the sweep
+    bus.SetSnapshotBuffer(snapshot, count);
+    uint32_t search = measure(bus, 0);
+    uint32_t warm   = measure(bus, 1);
+    uint32_t sweep  = measure(bus, 2);
+    unsigned found  = bus.ThermometersFound;
+    printf("%8u %6u %13.1f %13.1f %13.1f %16.0f\n", count, found, search / 1000.0, warm / 1000.0,
+           sweep / 1000.0, found ? (double)sweep / found : 0.0);
+    bus.SetSnapshotBuffer(nullptr, 0);
+    delete[] snapshot;
+  }  // for-next each bus size
+  return (0);
+}  // of method main()
@@ -9,31 +9,125 @@ See main library header file for details
 ** Declare constants used in the class, but ones that are not visible as public or private class  **
 ** components                                                                                     **
 ***************************************************************************************************/
-const uint8_t  DS18B20_FAMILY{0x28};         ///< The Family byte for DS18B20
-const uint8_t  DS18S20_FAMILY{0x10};         ///< The family byte for DS18S20
-const uint8_t  DS28EA00_FAMILY{0x42};        ///< The family byte for DS28EA00
-const uint8_t  DS1825_FAMILY{0x3B};          ///< The family byte for DS1825
-const uint8_t  DS1822_FAMILY{0x22};          ///< The family byte for DS1822
-const uint8_t  DS_START_CONVERT{0x44};       ///< Command to start conversion
-const uint8_t  DS_READ_SCRATCHPAD{0xBE};     ///< Command to read the temperature
-const uint8_t  DS_READ_POWER_SUPPLY{0xB4};   ///< Command to read the temperature
-const uint8_t  DS_WRITE_SCRATCHPAD{0x4E};    ///< Write to the DS scratchpad
-const uint8_t  DS_COPY_SCRATCHPAD{0x48};     ///< Copy the contents of scratchpad
-const uint8_t  DS_SKIP_ROM{0xCC};            ///< Skip the ROM address on 1-Wire
-const uint8_t  DS_SELECT_ROM{0x55};          ///< Select the ROM address on 1-Wire
-const uint8_t  DS_SEARCH{0xF0};              ///< Search the 1-Wire for devices
-const int16_t  DS_BAD_TEMPERATURE{0xFC90};   ///< Bad measurement value, -55°C
-const uint8_t  DS_MAX_NV_CYCLE_TIME{100};    ///< Max ms taken to write NV memory
-const uint8_t  DS_USER_BYTE_1{2};            ///< The 2nd scratchpad byte
-const uint8_t  DS_USER_BYTE_2{3};            ///< The 3rd scratchpad byte
-const uint8_t  DS_CONFIG_BYTE{4};            ///< The 4th scratchpad byte
-const uint16_t DS_12b_CONVERSION_TIME{750};  ///< Max ms taken to convert @ 12bits
-const uint16_t DS_11b_CONVERSION_TIME{375};  ///< Max ms taken to convert @ 11bits
-const uint16_t DS_10b_CONVERSION_TIME{188};  ///< Max ms taken to convert @ 10bits
-const uint16_t DS_9b_CONVERSION_TIME{94};    ///< Max ms taken to convert @ 9bits
+const uint8_t  DS18B20_FAMILY{0x28};           ///< The Family byte for DS18B20
+const uint8_t  DS18S20_FAMILY{0x10};           ///< The family byte for DS18S20
+const uint8_t  DS28EA00_FAMILY{0x42};          ///< The family byte for DS28EA00
+const uint8_t  DS1825_FAMILY{0x3B};            ///< The family byte for DS1825
+const uint8_t  DS1822_FAMILY{0x22};            ///< The family byte for DS1822
+const uint8_t  DS_READ_POWER_SUPPLY{0xB4};     ///< Command to read the temperature
+const uint8_t  DS_WRITE_SCRATCHPAD{0x4E};      ///< Write to the DS scratchpad
+const uint8_t  DS_COPY_SCRATCHPAD{0x48};       ///< Copy the contents of scratchpad
+const uint8_t  DS_SEARCH{0xF0};                ///< Search the 1-Wire for devices
+const uint8_t  DS_ALARM_SEARCH{0xEC};          ///< Search for devices outside their TH/TL limits
+const uint8_t  DS_MAX_NV_CYCLE_TIME{100};      ///< Max ms taken to write NV memory
+const uint8_t  DS_USER_BYTE_1{2};              ///< The 2nd scratchpad byte
+const uint8_t  DS_USER_BYTE_2{3};              ///< The 3rd scratchpad byte
+const uint8_t  DS_CONFIG_BYTE{4};              ///< The 4th scratchpad byte
+const uint16_t DS_12b_CONVERSION_TIME{750};    ///< Max ms taken to convert @ 12bits
+const uint16_t DS_11b_CONVERSION_TIME{375};    ///< Max ms taken to convert @ 11bits
+const uint16_t DS_10b_CONVERSION_TIME{188};    ///< Max ms taken to convert @ 10bits
+const uint16_t DS_9b_CONVERSION_TIME{94};      ///< Max ms taken to convert @ 9bits
+const uint16_t DS_CONVERSION_OVERRUN{250};     ///< Max ms to wait beyond the conversion time
+const uint8_t  DS_TABLE_MAGIC{0xD5};           ///< First byte of a valid ROM table header
+const uint8_t  DS_TABLE_LAYOUT{1};             ///< ROM table layout, changed with the format
+const uint8_t  DS_TABLE_OTHER_DEVICES{0x01};   ///< Header flag, bus has non-thermometer devices
+const uint8_t  DS_ROM_GROUPS{8};               ///< Offset of the group bits in a ROM table entry
+const uint8_t  DS_ROM_CALIBRATION{9};          ///< Offset of the calibration in a ROM table entry
+const uint8_t  DS_ROM_GAIN{11};                ///< Offset of the gain in a ROM table entry
+const int16_t  DS_MIN_RAW_TEMPERATURE{-880};   ///< Lowest reading of the devices, -55°C
+const int16_t  DS_MAX_RAW_TEMPERATURE{2000};   ///< Highest reading of the devices, 125°C
+const int16_t  DS_POWER_ON_TEMPERATURE{1360};  ///< Scratchpad value after power-on, 85°C
+const uint8_t  DS_FAILED_READ_SCORE{4};        ///< Error score of a read that failed altogether
+const uint8_t  DS_BACKOFF_LIMIT{10};           ///< Longest re-probe interval is 2^10 ticks
+const uint8_t  DS_PROBE_TICK_SHIFT{10};        ///< Re-probe times count millis() / 1024
+const int16_t  DS_CALIBRATION_SPREAD{32};      ///< Calibration readings always kept, 2°C
+const int16_t  DS_GAIN_SPAN{1280};             ///< Least gain point distance, 5°C in 1/16 units
+const uint8_t  DS_SCRATCHPAD_READ_MILLIS{12};  ///< Longest scratchpad read with CRC, no retries
+const uint16_t DS_ROM_TABLE_END{E2END + 1 - DS_TABLE_HEADER_SIZE};  ///< Header address, the
+                                                                    ///< entries are stored below
+const uint16_t DS_CONVERSION_TIME[4]{DS_9b_CONVERSION_TIME, DS_10b_CONVERSION_TIME,
+                                     DS_11b_CONVERSION_TIME,
+                                     DS_12b_CONVERSION_TIME};  ///< ms by resolution, 9-12 bits
+/** @brief  1-Wire CRC of each 4 bit value, used by crc8Nibble() */
+const uint8_t DS_CRC8_NIBBLES[16] PROGMEM{0x00, 0x9D, 0x23, 0xBE, 0x46, 0xDB, 0x65, 0xF8,
+                                          0x8C, 0x11, 0xAF, 0x32, 0xCA, 0x57, 0xE9, 0x74};
+/** @brief  1-Wire CRC of each byte value, used by crc8Table() */
+const uint8_t DS_CRC8_BYTES[256] PROGMEM{
+    0x00, 0x5E, 0xBC, 0xE2, 0x61, 0x3F, 0xDD, 0x83, 0xC2, 0x9C, 0x7E, 0x20, 0xA3, 0xFD, 0x1F, 0x41,
+    0x9D, 0xC3, 0x21, 0x7F, 0xFC, 0xA2, 0x40, 0x1E, 0x5F, 0x01, 0xE3, 0xBD, 0x3E, 0x60, 0x82, 0xDC,
+    0x23, 0x7D, 0x9F, 0xC1, 0x42, 0x1C, 0xFE, 0xA0, 0xE1, 0xBF, 0x5D, 0x03, 0x80, 0xDE, 0x3C, 0x62,
+    0xBE, 0xE0, 0x02, 0x5C, 0xDF, 0x81, 0x63, 0x3D, 0x7C, 0x22, 0xC0, 0x9E, 0x1D, 0x43, 0xA1, 0xFF,
+    0x46, 0x18, 0xFA, 0xA4, 0x27, 0x79, 0x9B, 0xC5, 0x84, 0xDA, 0x38, 0x66, 0xE5, 0xBB, 0x59, 0x07,
+    0xDB, 0x85, 0x67, 0x39, 0xBA, 0xE4, 0x06, 0x58, 0x19, 0x47, 0xA5, 0xFB, 0x78, 0x26, 0xC4, 0x9A,
+    0x65, 0x3B, 0xD9, 0x87, 0x04, 0x5A, 0xB8, 0xE6, 0xA7, 0xF9, 0x1B, 0x45, 0xC6, 0x98, 0x7A, 0x24,
+    0xF8, 0xA6, 0x44, 0x1A, 0x99, 0xC7, 0x25, 0x7B, 0x3A, 0x64, 0x86, 0xD8, 0x5B, 0x05, 0xE7, 0xB9,
+    0x8C, 0xD2, 0x30, 0x6E, 0xED, 0xB3, 0x51, 0x0F, 0x4E, 0x10, 0xF2, 0xAC, 0x2F, 0x71, 0x93, 0xCD,
+    0x11, 0x4F, 0xAD, 0xF3, 0x70, 0x2E, 0xCC, 0x92, 0xD3, 0x8D, 0x6F, 0x31, 0xB2, 0xEC, 0x0E, 0x50,
+    0xAF, 0xF1, 0x13, 0x4D, 0xCE, 0x90, 0x72, 0x2C, 0x6D, 0x33, 0xD1, 0x8F, 0x0C, 0x52, 0xB0, 0xEE,
+    0x32, 0x6C, 0x8E, 0xD0, 0x53, 0x0D, 0xEF, 0xB1, 0xF0, 0xAE, 0x4C, 0x12, 0x91, 0xCF, 0x2D, 0x73,
+    0xCA, 0x94, 0x76, 0x28, 0xAB, 0xF5, 0x17, 0x49, 0x08, 0x56, 0xB4, 0xEA, 0x69, 0x37, 0xD5, 0x8B,
+    0x57, 0x09, 0xEB, 0xB5, 0x36, 0x68, 0x8A, 0xD4, 0x95, 0xCB, 0x29, 0x77, 0xF4, 0xAA, 0x48, 0x16,
+    0xE9, 0xB7, 0x55, 0x0B, 0x88, 0xD6, 0x34, 0x6A, 0x2B, 0x75, 0x97, 0xC9, 0x4A, 0x14, 0xF6, 0xA8,
+    0x74, 0x2A, 0xC8, 0x96, 0x15, 0x4B, 0xA9, 0xF7, 0xB6, 0xE8, 0x0A, 0x54, 0xD7, 0x89, 0x6B, 0x35};
+#if defined(DS_PROFILE)
+  /** @brief  Charge the bus activity of the enclosing public function to a DSProfileCall group */
+  #define DS_PROFILE_CALL(call) ProfileScope profileScope(this, call)
+  /** @brief  Increment a counter of the group currently being charged */
+  #define DS_PROFILE_COUNT(counter) _Profile[_ProfileCall].counter++
+  /** @brief  Start timing a wait, slots used while waiting are not counted as wait time */
+  #define DS_PROFILE_WAIT_START           \
+    uint32_t profileWaitStart = micros(); \
+    uint32_t profileSlotStart = _Profile[_ProfileCall].slotMicros
+  /** @brief  Charge the time since DS_PROFILE_WAIT_START to the group currently being charged */
+  #define DS_PROFILE_WAIT_END                                            \
+    _Profile[_ProfileCall].waitMicros += (micros() - profileWaitStart) - \
+                                         (_Profile[_ProfileCall].slotMicros - profileSlotStart)
+/*!
+ * @class   DSFamily_Class::ProfileScope
+ * @brief   Charges the bus activity to a group for the lifetime of the object
+ * @details Only the outermost public function sets the group, so nested calls are charged to it
+ */
+class DSFamily_Class::ProfileScope {
+ public:
+  /*!
+    @brief     Start charging the bus activity to a group unless an outer call already does
+    @param[in] bus  Class instance being profiled
+    @param[in] call DSProfileCall group of the public function
+  */
+  ProfileScope(DSFamily_Class *bus, const uint8_t call)
+      : _Bus(bus), _Outer(bus->_ProfileCall == DS_CALL_OTHER) {
+    if (_Outer) {
+      bus->_ProfileCall = call;
+      bus->_Profile[call].calls++;
+    }  // if-then outermost public call
+  }
+  /*! @brief Stop charging the group when the outermost public function returns */
+  ~ProfileScope() {
+    if (_Outer) _Bus->_ProfileCall = DS_CALL_OTHER;
+  }
+
+ private:
+  DSFamily_Class *_Bus;    ///< Class instance being profiled
+  bool            _Outer;  ///< This is the outermost public call
+};  // of ProfileScope class definition
+#else
+  /** @brief  Profiling is compiled out */
+  #define DS_PROFILE_CALL(call)
+  /** @brief  Profiling is compiled out */
+  #define DS_PROFILE_COUNT(counter)
+  /** @brief  Profiling is compiled out */
+  #define DS_PROFILE_WAIT_START
+  /** @brief  Profiling is compiled out */
+  #define DS_PROFILE_WAIT_END
+#endif
 
 DSFamily_Class::DSFamily_Class(const uint8_t OneWirePin, const uint8_t ReserveRom)
-    : ConversionMillis(DS_12b_CONVERSION_TIME), _MaxThermometers((E2END - ReserveRom) / 8) {
+    : ConversionMillis(DS_12b_CONVERSION_TIME),
+      _MaxThermometers(min((DS_ROM_TABLE_END - ReserveRom) / DS_ROM_ENTRY_SIZE, DS_MAX_DEVICES)),
+      _RomTableEnd(DS_ROM_TABLE_END),
+      _ReserveRom(ReserveRom),
+      _Snapshot(_SnapshotBuffer),
+      _SnapshotSize(DS_SNAPSHOT_SIZE) {
   /*!
     @brief     Class constructor
     @details   Class Constructor instantiates the class and uses the initializer list to also
@@ -43,12 +137,33 @@ DSFamily_Class::DSFamily_Class(const uint8_t OneWirePin, const uint8_t ReserveRo
                EEPROM space available
     @param[in] OneWirePin 1-Wire microLAN pin number
     @param[in] ReserveRom (Optional) Number of bytes of ROM space to reserve, used to calculate
-    _MaxThermometers
+    _MaxThermometers, which is at most DS_MAX_DEVICES
   */
   pinMode(OneWirePin, INPUT);            // Make the 1-Wire pin an input
   bitmask = PIN_TO_BITMASK(OneWirePin);  // Set the bitmask
   baseReg = PIN_TO_BASEREG(OneWirePin);  // Set the base register
   reset_search();                        // Reset the search status
+  ClearRomCache();                                              // Nothing cached yet
+  memset(_DeviceResolution, 0, sizeof(_DeviceResolution));      // All devices default to 12 bits
+  memset(_DeviceConverting, 0, sizeof(_DeviceConverting));      // and no conversions active
+  memset(_DeviceExcluded, UINT8_MAX, sizeof(_DeviceExcluded));  // No outlier check done yet
+  memset(_DeviceRemoved, 0, sizeof(_DeviceRemoved));            // No device is removed
+  memset(_DeviceOffset, 0, sizeof(_DeviceOffset));              // No offset
+  memset(_DeviceGain, 0, sizeof(_DeviceGain));                  // and no gain
+  for (uint16_t i = 0; i < DS_SNAPSHOT_SIZE; i++) _SnapshotBuffer[i] = DS_BAD_TEMPERATURE;
+#if DS_QUARANTINE_SCORE > 0
+  memset(_DeviceScore, 0, sizeof(_DeviceScore));      // No read errors yet
+  memset(_DeviceBackoff, 0, sizeof(_DeviceBackoff));  // and no device is quarantined
+#endif
+#if DS_GROUP_COUNT > 0
+  memset(_GroupPeriod, 0, sizeof(_GroupPeriod));  // No group is scheduled
+#endif
+#if DS_ADAPTIVE_RESOLUTION > 0
+  memset(_AdaptiveStored, 0, sizeof(_AdaptiveStored));  // No resolution is lowered
+#endif
+#if defined(DS_PROFILE)
+  ResetProfile();  // Start with empty counters
+#endif
 }  // of class constructor
 DSFamily_Class::~DSFamily_Class() {
   /*!
@@ -56,7 +171,51 @@ DSFamily_Class::~DSFamily_Class() {
     @details Currently empty and unused
   */
 }
-uint8_t DSFamily_Class::ScanForDevices() {
+uint8_t DSFamily_Class::bus_reset() {
+  /*!
+    @brief   Perform a reset through the transport and count it when profiling
+    @return  Result of reset()
+  */
+#if defined(DS_PROFILE)
+  uint32_t start = micros();
+  uint8_t  r     = reset();
+  _Profile[_ProfileCall].slotMicros += micros() - start;
+  _Profile[_ProfileCall].resets++;
+  return (r);
+#else
+  return (reset());
+#endif
+}  // of method bus_reset()
+void DSFamily_Class::bus_write_bit(uint8_t v) {
+  /*!
+    @brief     Write a bit through the transport and count it when profiling
+    @param[in] v Only the LSB is used as the bit to write to 1-Wire
+  */
+#if defined(DS_PROFILE)
+  uint32_t start = micros();
+  write_bit(v);
+  _Profile[_ProfileCall].slotMicros += micros() - start;
+  _Profile[_ProfileCall].bitsWritten++;
+#else
+  write_bit(v);
+#endif
+}  // of method bus_write_bit()
+uint8_t DSFamily_Class::bus_read_bit() {
+  /*!
+    @brief   Read a bit through the transport and count it when profiling
+    @return  Result of read_bit()
+  */
+#if defined(DS_PROFILE)
+  uint32_t start = micros();
+  uint8_t  r     = read_bit();
+  _Profile[_ProfileCall].slotMicros += micros() - start;
+  _Profile[_ProfileCall].bitsRead++;
+  return (r);
+#else
+  return (read_bit());
+#endif
+}  // of method bus_read_bit()
+DSDeviceNumber DSFamily_Class::ScanForDevices(const bool warmStart) {
   /*!
     @brief   Use the standardized 1-Wire microLAN search mechanism to discover all DS devices
     @details Each device has a unique 8-byte ROM address, which is stored at the end of program's
@@ -65,99 +224,477 @@ uint8_t DSFamily_Class::ScanForDevices() {
              beginning of the EEPROM memory the maximum number of devices that can be processed by
              the class is variable. After each device is discovered the resolution is set to the
              maximum value and a conversion is initiated. This is done as soon as possible since a
-             conversion at maximum resolution takes up to 750ms
+             conversion at maximum resolution takes up to 750ms.\n\n
+             The table has a header with the layout version, the number of devices, a flags byte
+             and a CRC; each entry is protected by the CRC byte of the ROM address. If warmStart is
+             set and a valid table is found then each stored device is only confirmed with a single
+             scratchpad read and keeps its resolution, which avoids the search and the NV write with
+             its 100ms wait per device. If any stored device doesn't answer, the full search is done
+             instead.\n\n
+             The search numbers the devices in search order. A device which already has an entry
+             in a valid table takes it along to its new number, so its groups and calibration are
+             kept; entries are exchanged in the EEPROM for this, and the entry of a device not yet
+             found is moved behind the others while room is left
+    @param[in] warmStart (Optional) Try the stored table before searching the bus
     @return number of devices found
   */
+  DS_PROFILE_CALL(DS_CALL_SCAN);
   uint8_t tempTherm[8];
   _LastCommandWasConvert = false;
-  reset_search();  // Reset the search status
-  ThermometersFound = 0;
-  while (search(tempTherm))  // Use the 1-Wire "search" method
-  {
-    if (tempTherm[0] == DS18B20_FAMILY || tempTherm[0] == DS18S20_FAMILY ||
-        tempTherm[0] == DS28EA00_FAMILY || tempTherm[0] == DS1822_FAMILY ||
-        tempTherm[0] == DS1825_FAMILY) {
-      EEPROM.put(E2END - ((ThermometersFound + 1) * 8),
-                 tempTherm);                       // Write thermometer data to EEPROM
-      SetDeviceResolution(ThermometersFound, 12);  // Set to maximum resolution
-      if (ThermometersFound <= _MaxThermometers) ThermometersFound++;  // Increment if we have room
-    }                                // of if-then we have a DS18x20 family device
-  }                                  // of while there are still new devices on the 1-Wire bus
-  reset();                           // Reset the 1-Wire bus
+  SnapshotValid          = false;  // Device numbering might change
+#if DS_DEVICE_STATISTICS > 0
+  ResetStatistics();  // and the statistics start over
+#endif
+#if DS_GROUP_COUNT > 0
+  _GroupConverting = 0;  // Group sweeps start over
+#endif
+#if DS_QUARANTINE_SCORE > 0
+  memset(_DeviceScore, 0, sizeof(_DeviceScore));      // Device health starts over
+  memset(_DeviceBackoff, 0, sizeof(_DeviceBackoff));  // and quarantines are lifted
+#endif
+#if DS_ADAPTIVE_RESOLUTION > 0
+  WriteAdaptedResolutions(DS_ALL_DEVICES, false);      // Lowered devices get their own resolution
+  memset(_AdaptiveStored, 0, sizeof(_AdaptiveStored));  // back before they are renumbered
+#endif
+  if (!warmStart || !LoadRomTable()) {
+    DSDeviceNumber stored = StoredDevices();  // Old entries, at and above ThermometersFound
+    reset_search();                           // Reset the search status
+    ClearRomCache();                          // Table is rebuilt
+    ThermometersFound = 0;                    // and starts out empty,
+    _OtherDevices     = false;                // as yet without other devices,
+    WriteRomHeader();                         // which the header shows if the scan stops
+    while (search(tempTherm, DS_SEARCH))  // Use the 1-Wire "search" method
+    {
+      if (!ThermometerFamily(tempTherm[0])) {
+        FamilySkip();          // Other devices of this family can't be thermometers either
+        _OtherDevices = true;  // and COPY SCRATCHPAD mustn't be broadcast
+        continue;
+      }  // if-then not a DS18x20 family device
+      if (ThermometersFound == _MaxThermometers) break;  // No room for another entry
+      DSDeviceNumber entry = ThermometersFound;          // Old entry of the device
+      while (entry < stored && !EntryHoldsDevice(entry, tempTherm)) entry++;
+      if (entry < stored) {
+        SwapRomEntries(ThermometersFound, entry);  // Entry moves with its device
+      } else if (ThermometersFound < stored && stored < _MaxThermometers) {
+        SwapRomEntries(ThermometersFound, stored++);  // New device, keep the old entry
+      }  // if-then-else known device or old entry in the way
+      bool added = WriteRomEntry(ThermometersFound, tempTherm);  // Write data to EEPROM
+      ThermometersFound++;
+      if (added) ImportCalibration(ThermometersFound - 1);  // Keep an old calibration
+      SetDeviceResolution(ThermometersFound - 1, 12);       // Set to maximum resolution
+    }                                                       // of while devices are found
+    WriteRomHeader();                                       // Table is complete
+  }                                                         // if-then no warm start
+  FillRomCache();                    // Cache all devices if they fit
+  bus_reset();                       // Reset the 1-Wire bus
   write_byte(DS_SKIP_ROM);           // Send Skip ROM code
   write_byte(DS_READ_POWER_SUPPLY);  // Send command to read power supply
-  Parasitic = !read_bit();           // Read the power status from bus
+  Parasitic = !bus_read_bit();       // Read the power status from bus
   DeviceStartConvert();              // Start conversion for all devices
   return (ThermometersFound);        // return number of devices detected
 }  // of method ScanForDevices
-boolean DSFamily_Class::Read1WireScratchpad(const uint8_t deviceNumber, uint8_t buffer[9]) {
+DSDeviceNumber DSFamily_Class::RescanDevices() {
+  /*!
+    @brief      Bring the ROM table up to date with the devices on the bus without renumbering
+    @details    Unlike ScanForDevices(), which rebuilds the table in search order, this compares
+                the devices found by one search of the bus with the stored table. Known devices keep
+                their device number together with their groups and calibration, and their entries
+                aren't written. New devices are appended to the table and removed devices are
+                marked as such by inverting the CRC byte of their entry, which is a single EEPROM
+                write; reads of a removed device fail at once without using the bus, and if the
+                device comes back it gets its old entry again. Families other than the thermometers
+                are skipped as a whole during the search. When no device at all answers the reset
+                the table is left alone, as this is more likely to be a bus fault. This is cheap
+                enough to be called periodically to detect devices being plugged in or out
+    @return     Number of devices added, returned or removed, 0 if the table didn't change
+  */
+  DS_PROFILE_CALL(DS_CALL_SCAN);
+  uint8_t        rom[8], stored[8];
+  uint8_t        seen[(DS_MAX_DEVICES + 7) / 8] = {0};  // 1 bit/device, found on the bus
+  DSDeviceNumber changes = 0;                           // Entries added or changed
+  bool           others  = false;                       // Non-thermometer devices found
+  if (ThermometersFound == 0) return (ScanForDevices());
+  _LastCommandWasConvert = false;
+  if (!bus_reset()) return (0);  // Bus fault or no devices, keep the table
+  reset_search();
+  while (search(rom, DS_SEARCH)) {
+    if (!ThermometerFamily(rom[0])) {
+      FamilySkip();  // Other devices of this family can't be thermometers either
+      others = true;
+      continue;
+    }  // if-then not a thermometer
+    DSDeviceNumber device = 0;      // Entry of the device in the table
+    bool           added  = false;  // Device is new
+    for (; device < ThermometersFound; device++) {
+      ReadRomEntry(device, stored);
+      if (memcmp(rom, stored, 7) == 0) break;
+    }  // for-next each stored device
+    if (device == ThermometersFound) {
+      if (ThermometersFound >= _MaxThermometers) continue;  // No room for another entry
+      ThermometersFound++;
+      added = true;
+    }  // if-then new device
+    if (added || DeviceRemoved(device)) {
+      if (WriteRomEntry(device, rom)) ImportCalibration(device);  // Appended or returned device
+      ConfirmDevice(device);
+      changes++;
+    }  // if-then entry changed
+    seen[device >> 3] |= 1 << (device & 7);
+  }  // of while devices are found
+  for (DSDeviceNumber device = 0; device < ThermometersFound; device++) {
+    if (!(seen[device >> 3] & (1 << (device & 7))) && !DeviceRemoved(device)) {
+      MarkRemoved(device, true);
+      changes++;
+    }  // if-then device has gone
+  }    // for-next each stored device
+  _OtherDevices = others;
+  WriteRomHeader();  // Only writes a changed count or flag
+  if (changes) {
+    FillRomCache();  // All devices might still fit
+    SnapshotValid = false;
+    bus_reset();
+    write_byte(DS_SKIP_ROM);
+    write_byte(DS_READ_POWER_SUPPLY);
+    Parasitic = !bus_read_bit();  // A new device might be parasitic
+  }                               // if-then table changed
+  return (changes);
+}  // of method RescanDevices()
+bool DSFamily_Class::VerifyDevice(const DSDeviceNumber deviceNumber) {
+  /*!
+    @brief      Check if a device is still on the bus without reading it
+    @details    A single pass of the search algorithm is steered along the stored address of the
+                device, which takes one reset and 192 slots regardless of the number of devices
+                and involves neither a scratchpad read nor retries. A removed device is checked
+                as well, but its entry isn't changed, see VerifyDevices() for that
+    @param[in]  deviceNumber 1-Wire device number
+    @return     "true" if the device answered
+  */
+  DS_PROFILE_CALL(DS_CALL_SCAN);
+  uint8_t rom[8];
+  if (deviceNumber >= ThermometersFound) return (false);
+  ParasiticWait();  // Wait for conversions to finish if there are parasitic devices
+  _LastCommandWasConvert = false;
+  ReadRomEntry(deviceNumber, rom);
+  rom[7] = crc8(rom, 7);  // The CRC byte of a removed device is inverted
+  return (verify(rom));
+}  // of method VerifyDevice()
+DSDeviceNumber DSFamily_Class::VerifyDevices() {
+  /*!
+    @brief      Check that every device in the ROM table is still on the bus
+    @details    Each device is checked with VerifyDevice(). Devices which don't answer are marked as
+                removed in the same way as RescanDevices() does, so that subsequent reads and
+                snapshots skip them at once instead of retrying, and removed devices which answer
+                again are restored. Only the entries of devices which changed state are written
+    @return     Number of devices missing from the bus
+  */
+  DS_PROFILE_CALL(DS_CALL_SCAN);
+  DSDeviceNumber missing = 0;  // Devices which didn't answer
+  for (DSDeviceNumber device = 0; device < ThermometersFound; device++) {
+    const bool present = VerifyDevice(device);
+    if (present == DeviceRemoved(device)) {
+      MarkRemoved(device, !present);
+      if (present) ConfirmDevice(device);  // Track the resolution of the returned device
+    }                                      // if-then state changed
+    if (!present) missing++;
+  }  // for-next each stored device
+  return (missing);
+}  // of method VerifyDevices()
+bool DSFamily_Class::DeviceRemoved(const DSDeviceNumber deviceNumber) {
+  /*!
+    @brief      Check if RescanDevices() or VerifyDevices() found that a device has been removed
+    @details    Removed devices keep their entry in the ROM table with an inverted CRC byte. Since
+                every scratchpad read checks this, WriteRomEntry() keeps a copy of the state in a
+                bitmap, so no EEPROM access is needed
+    @param[in]  deviceNumber 1-Wire device number
+    @return     "true" if the device has been removed or doesn't exist
+  */
+  if (deviceNumber >= ThermometersFound) return (true);
+  return (_DeviceRemoved[deviceNumber >> 3] & (1 << (deviceNumber & 7)));
+}  // of method DeviceRemoved()
+void DSFamily_Class::MarkRemoved(const DSDeviceNumber deviceNumber, const bool removed) {
+  /*!
+    @brief      Mark the ROM table entry of a device as removed or present
+    @details    Only the CRC byte of the entry is written, groups and calibration are kept
+    @param[in]  deviceNumber 1-Wire device number
+    @param[in]  removed "true" to invert the CRC byte, "false" to restore it
+  */
+  uint8_t rom[8];
+  ReadRomEntry(deviceNumber, rom);
+  rom[7] = crc8(rom, 7) ^ (removed ? 0xFF : 0x00);
+  WriteRomEntry(deviceNumber, rom);
+}  // of method MarkRemoved()
+bool DSFamily_Class::ConfirmDevice(const DSDeviceNumber deviceNumber) {
+  /*!
+    @brief      Read the scratchpad of a stored device and track its resolution
+    @details    Used for devices which are not set to 12 bits by ScanForDevices(), so that their
+                current resolution is kept and no NV write is needed
+    @param[in]  deviceNumber 1-Wire device number
+    @return     "true" if the device returned a valid scratchpad
+  */
+  uint8_t dsBuffer[9];
+  if (!Read1WireScratchpad(deviceNumber, dsBuffer)) return (false);
+  SetTrackedResolution(deviceNumber, ROM_NO[0] == DS18S20_FAMILY
+                                         ? 12
+                                         : ((dsBuffer[DS_CONFIG_BYTE] >> 5) & 3) + 9);
+  ConversionMillis =
+      max(ConversionMillis, DS_CONVERSION_TIME[TrackedResolution(deviceNumber) - 9]);
+  return (true);
+}  // of method ConfirmDevice()
+bool DSFamily_Class::ThermometerFamily(const uint8_t family) {
+  /*!
+    @brief      Check if a family code belongs to one of the supported thermometers
+    @param[in]  family First byte of the ROM address
+    @return     "true" for a DS18B20, DS18S20, DS28EA00, DS1822 or DS1825
+  */
+  return (family == DS18B20_FAMILY || family == DS18S20_FAMILY || family == DS28EA00_FAMILY ||
+          family == DS1822_FAMILY || family == DS1825_FAMILY);
+}  // of method ThermometerFamily()
+void DSFamily_Class::FamilySkip() {
+  /*!
+    @brief      Make the next search() skip the remaining devices of the family just found
+    @details    The search continues at the last discrepancy within the family code, so all other
+                devices with the same family code are passed over without a search pass each
+  */
+  LastDiscrepancy       = LastFamilyDiscrepancy;
+  LastFamilyDiscrepancy = 0;
+  if (LastDiscrepancy == 0) LastDeviceFlag = true;
+}  // of method FamilySkip()
+boolean DSFamily_Class::Read1WireScratchpad(const DSDeviceNumber deviceNumber, uint8_t buffer[9]) {
   /*!
     @brief     read the scratchpad contents from a given DS device
+    @details   A read with a bad CRC is repeated as allowed by ReadAttempts(). After the first bad
+               read the device is checked with verify() and not read again if it has gone
     @param[in] deviceNumber 1-Wire device number
     @param[in] buffer 8-byte scratchpad contents from device
     @return    "true" if successful otherwise "false"
   */
-  _LastCommandWasConvert = false;            // Set switch to false
-  bool    CRCStatus      = false;            // default to a bad reading
-  uint8_t ErrorCounter   = 0;                // Count number of bad readings
-  while (!CRCStatus && ErrorCounter++ < 10)  // Loop until good read or overflow
+  _LastCommandWasConvert = false;                       // Set switch to false
+  bool    CRCStatus      = false;                       // default to a bad reading
+  uint8_t ErrorCounter   = 0;                           // Count number of bad readings
+  uint8_t attempts       = ReadAttempts(deviceNumber);  // Reads allowed
+  if (attempts == 0) return (false);  // Removed or quarantined, don't use the bus
+  while (!CRCStatus && ErrorCounter < attempts)  // Loop until good read or budget used up
   {
+    uint8_t crc = 0;                 // CRC of the bytes read so far
     SelectDevice(deviceNumber);      // Reset the 1-wire, address device
     write_byte(DS_READ_SCRATCHPAD);  // Request device to send Scratchpad contents
     for (uint8_t i = 0; i < 9; i++) {
       buffer[i] = read_byte();
-    }                                          // for-next read each scratchpad byte
-    CRCStatus = crc8(buffer, 8) == buffer[8];  // Check to see if result is valid
-  }                    // of loop until good read or number of errors exceeded
+      crc       = crc8Update(crc, buffer[i]);
+    }                      // for-next read each scratchpad byte
+    CRCStatus = crc == 0;  // 0 over data and CRC byte if result is valid
+    if (!CRCStatus) {
+      ErrorCounter++;
+      if (ErrorCounter == 1 && attempts > 1 && !verify(ROM_NO)) attempts = 1;  // Gone, no retry
+#if defined(DS_PROFILE)
+      DS_PROFILE_COUNT(crcFailures);
+      if (ErrorCounter < attempts) {
+        DS_PROFILE_COUNT(retries);  // The read is repeated
+        if (deviceNumber < DS_MAX_TRACKED_DEVICES) _DeviceRetries[deviceNumber]++;
+      }  // if-then another attempt follows
+#endif
+    }  // if-then bad CRC
+  }    // of loop until good read or number of errors exceeded
+  ReadFinished(deviceNumber, CRCStatus, CRCStatus ? ErrorCounter : ErrorCounter - 1);
   return (CRCStatus);  // Return false if bad CRC checksum
 }  // of method Read1WireScratchpad()
-int16_t DSFamily_Class::ReadDeviceTemp(const uint8_t deviceNumber, const bool raw) {
+uint8_t DSFamily_Class::ReadAttempts(const DSDeviceNumber deviceNumber) {
+  /*!
+    @brief     Number of times a scratchpad read of a device may be tried
+    @details   This is one more than the retries per read set by SetRetryBudget(), or than what is
+               left of the retry budget of the current sweep if that is less. A quarantined device
+               is read only once when its re-probe is due, and not at all before that
+    @param[in] deviceNumber 1-Wire device number
+    @return    Number of attempts, 0 if the device mustn't be read
+  */
+  if (DeviceRemoved(deviceNumber)) return (0);  // Not on the bus
+#if DS_QUARANTINE_SCORE > 0
+  if (deviceNumber < DS_MAX_TRACKED_DEVICES && _DeviceBackoff[deviceNumber]) {
+    uint16_t now = millis() >> DS_PROBE_TICK_SHIFT;
+    return ((int16_t)(now - _DeviceProbe[deviceNumber]) >= 0 ? 1 : 0);  // Re-probe when due
+  }  // if-then device is quarantined
+#endif
+  return (min(_ReadRetries, _SweepRetriesLeft) + 1);
+}  // of method ReadAttempts()
+void DSFamily_Class::ReadFinished(const DSDeviceNumber deviceNumber, const bool good,
+                                  const uint8_t repeats) {
+  /*!
+    @brief     Charge the repeated reads to the sweep budget and update the error score
+    @details   Each repeated read adds 1 to the error score of a device and a read that failed
+               altogether adds another DS_FAILED_READ_SCORE, while a good read halves the score.
+               A device whose score reaches DS_QUARANTINE_SCORE is quarantined: it isn't read for
+               about a second and is then re-probed with a single read. Each failed re-probe
+               doubles the interval up to about 17 minutes, a good one lifts the quarantine
+    @param[in] deviceNumber 1-Wire device number
+    @param[in] good "true" if the scratchpad was read
+    @param[in] repeats Number of reads after the first one
+  */
+  if (_SweepRetriesLeft != UINT8_MAX) _SweepRetriesLeft -= repeats;  // Budget of the sweep
+#if DS_QUARANTINE_SCORE > 0
+  if (deviceNumber >= DS_MAX_TRACKED_DEVICES) return;
+  uint16_t score = _DeviceScore[deviceNumber] + repeats;
+  if (good) {
+    _DeviceScore[deviceNumber]   = score / 2;
+    _DeviceBackoff[deviceNumber] = 0;  // Quarantine, if any, is lifted
+    return;
+  }  // if-then good read
+  if (_DeviceBackoff[deviceNumber] == 0) {
+    score += DS_FAILED_READ_SCORE;
+    _DeviceScore[deviceNumber] = score > UINT8_MAX ? UINT8_MAX : score;
+    if (score < DS_QUARANTINE_SCORE) return;
+  }  // if-then not yet quarantined
+  if (_DeviceBackoff[deviceNumber] <= DS_BACKOFF_LIMIT) _DeviceBackoff[deviceNumber]++;
+  _DeviceProbe[deviceNumber] =
+      (millis() >> DS_PROBE_TICK_SHIFT) + (1 << (_DeviceBackoff[deviceNumber] - 1));
+#else
+  (void)deviceNumber;
+  (void)good;
+#endif
+}  // of method ReadFinished()
+void DSFamily_Class::SetRetryBudget(const uint8_t perRead, const uint8_t perSweep) {
+  /*!
+    @brief     Limit the number of times scratchpad reads with a bad CRC are repeated
+    @details   Each repeat costs a reset, the device selection and 72 read slots, about 11ms. The
+               per-read limit applies to every read, the per-sweep limit is shared by all reads of
+               one TakeSnapshot() or of one group in ServiceGroups(), so that the time a sweep
+               takes stays bounded however many devices are failing. The defaults are
+               DS_READ_RETRIES and DS_SWEEP_RETRIES
+    @param[in] perRead Repeats of a single read, at most 254
+    @param[in] perSweep (Optional) Repeats of all reads of a sweep together, UINT8_MAX for no limit
+  */
+  _ReadRetries  = min(perRead, (uint8_t)(UINT8_MAX - 1));
+  _SweepRetries = perSweep;
+}  // of method SetRetryBudget()
+uint8_t DSFamily_Class::GetDeviceStatus(const DSDeviceNumber deviceNumber) {
+  /*!
+    @brief     Return the health of a device as seen by the recent reads
+    @details   The error score and quarantine are only kept for the first DS_MAX_TRACKED_DEVICES
+               devices, others are always reported as DS_DEVICE_OK unless removed. ScanForDevices()
+               clears the status of all devices
+    @param[in] deviceNumber 1-Wire device number
+    @return    One of the DSDeviceStatus values
+  */
+  if (DeviceRemoved(deviceNumber)) return (DS_DEVICE_REMOVED);
+#if DS_QUARANTINE_SCORE > 0
+  if (deviceNumber < DS_MAX_TRACKED_DEVICES) {
+    if (_DeviceBackoff[deviceNumber]) return (DS_DEVICE_QUARANTINED);
+    if (_DeviceScore[deviceNumber]) return (DS_DEVICE_DEGRADED);
+  }  // if-then status is tracked
+#endif
+  return (DS_DEVICE_OK);
+}  // of method GetDeviceStatus()
+int16_t DSFamily_Class::ReadDeviceTemp(const DSDeviceNumber deviceNumber, const bool raw) {
   /*!
     @brief   return the current temperature value for a given device number
     @details All devices except the DS18S20 return raw values in 0.0625°C increments, so the 0.5°C
              increments of the DS18S20 are converted to the same scale as the other devices. A check
-             is done to see if there are still conversion(s) being done and a delay is made until
-             any conversions have time to complete. We only store the value for conversion start
-             time, so the delay might be for another devices and might not be necessary, but the
-             alternative is to store the conversion times for each device which would potentially
-             consume a lot  of available memory
+             is done to see if the device is still converting and a delay is made until the
+             conversion has had time to complete. The resolution and conversion deadline of the
+             first DS_MAX_TRACKED_DEVICES devices are tracked individually, so only the device
+             being read is waited for; but when parasitic devices are present the bus is blocked
+             until all conversions are done. The wait is bounded, use poll() beforehand to avoid
+             blocking altogether
    @param[in] deviceNumber 1-Wire device number
    @param[in] raw (Optional, default "false") If set to "true" then the raw reading is returned,
              otherwise the compensated calibrated value is returned
    @return Temperature reading in device units
   */
+  DS_PROFILE_CALL(DS_CALL_READ_TEMP);
   uint8_t dsBuffer[9];
   int16_t temperature = DS_BAD_TEMPERATURE;  // Default return is error value
-  if (Parasitic || !_LastCommandWasConvert)  // Wait a fixed time in parasite or
-  {
-    if ((_ConvStartTime + ConversionMillis) > millis()) {
-      delay(millis() - (_ConvStartTime + ConversionMillis));  // Wait for conversion to finish
-    }                                                         // if-then-else conversion is active
-  } else {
-    if (_LastCommandWasConvert) {
-      while (read_bit() == 0)
-        ;  // Loop until bit goes high after conversion has finished
-    }      // if-then last command was conversion
-  }        // if-then-else parasitic or conversion active
+  DS_PROFILE_WAIT_START;
+  while (DeviceConverting(deviceNumber)) {
+    yield();  // Wait for this device's conversion to finish
+  }           // of while device is converting
+  DS_PROFILE_WAIT_END;
   if (deviceNumber < ThermometersFound &&
-      Read1WireScratchpad(deviceNumber, dsBuffer))  // Successful read from device
+      ((_ReadIntegrity == DS_INTEGRITY_PLAUSIBLE && ReadPlausible(deviceNumber, dsBuffer)) ||
+       Read1WireScratchpad(deviceNumber, dsBuffer)))  // Successful read from device
   {
-    if (ROM_NO[0] == DS1822_FAMILY)  // If DS1822 then temp is different
-    {
-      temperature = ((dsBuffer[1] << 8) | dsBuffer[0]) << 3;    // get the raw reading and apply
-      temperature = (temperature & 0xFFF0) + 12 - dsBuffer[6];  // value from "count remain" byte
-    } else {
-      temperature = (dsBuffer[1] << 8) | dsBuffer[0];  // Results come in 2s complement
-    }                                                  // if-then-else a DS1822
-    if ((dsBuffer[2] ^ dsBuffer[3]) == 0xFF &&
-        !raw)  // Apply any calibration offset if raw is not true
-    {
-      temperature += (int8_t)dsBuffer[2];
-    }  // if-then calibrated device and raw is not true
-  }    // of if-then the read was successful
+    temperature = ScratchpadTemp(deviceNumber, dsBuffer, raw);
+  }  // of if-then the read was successful
   return (temperature);
 }  // of method ReadDeviceTemp()
-void DSFamily_Class::DeviceStartConvert(const uint8_t deviceNumber, const bool WaitSwitch) {
+bool DSFamily_Class::ReadPlausible(const DSDeviceNumber deviceNumber, uint8_t buffer[9]) {
+  /*!
+    @brief     Read just the start of the scratchpad and check the reading for plausibility
+    @details   Only the 2 temperature bytes are read. The rest of the transfer is cut short by the
+               reset which starts the next command, so no extra reset is needed. Without the CRC
+               the reading is accepted only if it isn't all ones, is within the range of the
+               devices, isn't the 85°C power-on value and differs from the reading of the device in
+               the snapshot by at most DS_PLAUSIBLE_DELTA. DS18S20 devices need the "count remain"
+               byte and aren't read this way. If any check fails the caller does a full read with
+               CRC, so a suspicious reading costs one short read more
+    @param[in] deviceNumber 1-Wire device number
+    @param[out] buffer Scratchpad contents, only the bytes read are valid
+    @return    "true" if a plausible reading was read
+  */
+  uint8_t ones = 0xFF;  // AND of all bytes read
+  if (ReadAttempts(deviceNumber) == 0) return (false);  // Leave it to the full read
+  ParasiticWait();                                      // as SelectDevice() would
+  ReadRomEntry(deviceNumber, ROM_NO);
+  if (ROM_NO[0] == DS18S20_FAMILY) return (false);  // Needs byte 6
+  _LastCommandWasConvert = false;
+  bus_reset();
+  select(ROM_NO);  // Address already read, unlike SelectDevice()
+  write_byte(DS_READ_SCRATCHPAD);
+  for (uint8_t i = 0; i < 2; i++) {
+    buffer[i] = read_byte();
+    ones &= buffer[i];
+  }  // for-next each temperature byte, the reset of the next command ends the transfer
+  int16_t temperature = (buffer[1] << 8) | buffer[0];
+  if (ones == 0xFF || temperature < DS_MIN_RAW_TEMPERATURE ||
+      temperature > DS_MAX_RAW_TEMPERATURE || temperature == DS_POWER_ON_TEMPERATURE) {
+    return (false);
+  }  // if-then implausible reading
+  if (deviceNumber < _SnapshotSize && _Snapshot[deviceNumber] != DS_BAD_TEMPERATURE) {
+    int16_t delta = ScratchpadTemp(deviceNumber, buffer, false) - _Snapshot[deviceNumber];
+    if (delta > DS_PLAUSIBLE_DELTA || delta < -DS_PLAUSIBLE_DELTA) return (false);
+  }  // if-then there is an earlier reading
+  ReadFinished(deviceNumber, true, 0);
+  return (true);
+}  // of method ReadPlausible()
+void DSFamily_Class::SetReadIntegrity(const uint8_t integrity) {
+  /*!
+    @brief     Choose how the temperature reads of ReadDeviceTemp() and TakeSnapshot() are checked
+    @details   DS_INTEGRITY_CRC, the default, reads all 9 bytes of the scratchpad and checks the
+               CRC, which takes 72 read slots. DS_INTEGRITY_PLAUSIBLE reads 2 bytes and checks
+               the reading for plausibility instead, see ReadPlausible(), which leaves only the
+               reset and the device selection as the main cost of a read. Other functions always
+               check the CRC
+    @param[in] integrity DS_INTEGRITY_CRC or DS_INTEGRITY_PLAUSIBLE
+  */
+  _ReadIntegrity = integrity;
+}  // of method SetReadIntegrity()
+int16_t DSFamily_Class::ScratchpadTemp(const DSDeviceNumber deviceNumber, const uint8_t buffer[9],
+                                       const bool raw) {
+  /*!
+    @brief     Convert the scratchpad contents of the device in ROM_NO to a temperature
+    @details   The calibration is applied in units of 1/16 of a device unit: the reading is scaled
+               by the gain, the offset is added and the result is rounded to device units, so
+               offsets and gains below one device unit still move the readings correctly on average
+    @param[in] deviceNumber 1-Wire device number, used for the calibration
+    @param[in] buffer 9-byte scratchpad contents with a valid CRC
+    @param[in] raw If set to "true" then the calibration is not applied
+    @return    Temperature reading in device units
+  */
+  int16_t temperature;
+  if (ROM_NO[0] == DS18S20_FAMILY)  // If DS18S20 then temp is different
+  {
+    temperature = ((buffer[1] << 8) | buffer[0]) << 3;      // get the raw reading and apply
+    temperature = (temperature & 0xFFF0) + 12 - buffer[6];  // value from "count remain" byte
+  } else {
+    temperature = (buffer[1] << 8) | buffer[0];  // Results come in 2s complement
+  }                                              // if-then-else a DS18S20
+  if (!raw) {
+    int16_t offset = ReadEntryWord(deviceNumber, DS_ROM_CALIBRATION);  // 1/16 device units
+    int32_t value  = (int32_t)temperature << 4;                         // in the same units
+    value += ((value * ReadEntryWord(deviceNumber, DS_ROM_GAIN)) >> 16) + offset;
+    temperature = (value + 8) >> 4;  // Rounded to device units
+  }                                  // if-then calibrated value requested
+  return (temperature);
+}  // of method ScratchpadTemp()
+void DSFamily_Class::DeviceStartConvert(const DSDeviceNumber deviceNumber, const bool WaitSwitch) {
   /*!
     @brief     Start the sampling and conversion on a device
     @details   At maximum resolution this conversion can take 750ms. If the optional deviceNumber
@@ -168,268 +705,1708 @@ void DSFamily_Class::DeviceStartConvert(const uint8_t deviceNumber, const bool W
     @param[in] WaitSwitch (Optional, default "false"). When "true" the call doesn't return until
                measurements have completed
   */
-  ParasiticWait();                // Wait for conversion to complete if necessary
-  if (deviceNumber == UINT8_MAX)  // if default for all devices
+  DS_PROFILE_CALL(DS_CALL_START_CONVERT);
+  ParasiticWait();                     // Wait for conversion to complete if necessary
+  if (deviceNumber == DS_ALL_DEVICES)  // if default for all devices
   {
-    reset();                  // Reset 1-wire network
+    bus_reset();              // Reset 1-wire network
     write_byte(DS_SKIP_ROM);  // Tell all devices to listen
   } else {
     SelectDevice(deviceNumber);
-  }                                   // if-then-else all devices or just one
-  write_byte(DS_START_CONVERT);       // Initiate temperature conversion
-  _ConvStartTime         = millis();  // Store start time of conversion
-  _LastCommandWasConvert = true;      // Set switch to true
-  if (WaitSwitch)                     // Don't return until finished
-  {
-    if (Parasitic) {
-      ParasiticWait();  // wait a fixed period when in parasite mode
-    } else {
-      while (read_bit() == 0)
-        ;  // Wait until read bit goes high when conversion finished
-    }      // if-then-else Parasitic
-  }        // if-then Waitswitch set
+  }                                     // if-then-else all devices or just one
+  write_byte(DS_START_CONVERT);         // Initiate temperature conversion
+  ConversionStarted(deviceNumber);      // Track the deadlines
+  if (WaitSwitch) WaitForConversion();  // Don't return until finished
 }  // of method DeviceStartConvert
+void DSFamily_Class::ConversionStarted(const DSDeviceNumber deviceNumber) {
+  /*!
+    @brief     Update the conversion state after CONVERT T has been sent to one or all devices
+    @param[in] deviceNumber 1-Wire device number, DS_ALL_DEVICES for all devices
+  */
+  uint32_t now      = millis();  // Store start time of conversion
+  uint16_t duration;             // Time the conversion takes
+  bool     pollable = true;      // Bus shows the end of all conversions
+  if (deviceNumber == DS_ALL_DEVICES) {
+    for (DSDeviceNumber i = 0; i < ThermometersFound; i++) StartDeviceDeadline(i, now);
+    duration = ConversionMillis;  // Slowest of all devices
+  } else {
+    StartDeviceDeadline(deviceNumber, now);
+    duration = DS_CONVERSION_TIME[TrackedResolution(deviceNumber) - 9];
+  }  // if-then-else all devices or just one
+  if (_ConvState == DS_CONVERSION_ACTIVE && (now - _ConvStartTime) < _ConvDuration &&
+      _ConvDuration - (now - _ConvStartTime) > duration) {
+    duration = _ConvDuration - (now - _ConvStartTime);  // Earlier conversion is still running
+    pollable = false;  // Bus only shows the end of the device addressed last
+  }                    // if-then earlier conversion ends later
+  _ConvStartTime         = now;
+  _ConvDuration          = duration;
+  _LastCommandWasConvert = pollable;  // Otherwise poll() uses the time
+  _ConvState             = DS_CONVERSION_ACTIVE;
+  SnapshotValid          = false;
+}  // of method ConversionStarted()
+uint8_t DSFamily_Class::poll() {
+  /*!
+    @brief     Non-blocking check on the state of the last conversion started
+    @details   Call repeatedly after DeviceStartConvert() and do other work until the conversion is
+               no longer active. When no parasitic devices are present and the last bus command was
+               the conversion, then a single read slot (about 70us) is used to see if the devices
+               have released the bus; otherwise completion is determined by the elapsed time. Time
+               is computed as the unsigned difference to the start, so the millis() rollover after
+               49 days is handled correctly. If the bus doesn't signal completion within
+               DS_CONVERSION_OVERRUN milliseconds of the expected conversion time then the state is
+               set to DS_CONVERSION_TIMEOUT so that callers never hang on a stuck bus
+    @return    DS_CONVERSION_IDLE, DS_CONVERSION_ACTIVE, DS_CONVERSION_DONE or DS_CONVERSION_TIMEOUT
+               for the longest-running of all active conversions
+  */
+  DS_PROFILE_CALL(DS_CALL_POLL);
+  if (_ConvState == DS_CONVERSION_ACTIVE) {
+    uint32_t elapsed = millis() - _ConvStartTime;  // Rollover-safe elapsed time
+    if (Parasitic || !_LastCommandWasConvert)      // Bus can't be polled, use the time
+    {
+      if (elapsed >= _ConvDuration) _ConvState = DS_CONVERSION_DONE;
+    } else {
+      if (bus_read_bit()) {
+        _ConvState = DS_CONVERSION_DONE;  // Devices released the bus
+      } else if (elapsed >= (uint32_t)_ConvDuration + DS_CONVERSION_OVERRUN) {
+        _ConvState = DS_CONVERSION_TIMEOUT;  // Bus is stuck low
+      }  // if-then-else bus released
+    }    // if-then-else bus can be polled
+    if (_ConvState != DS_CONVERSION_ACTIVE) {
+      memset(_DeviceConverting, 0, sizeof(_DeviceConverting));  // No device is converting now
+    }  // if-then conversion finished
+  }    // if-then conversion active
+  return (_ConvState);
+}  // of method poll()
+void DSFamily_Class::WaitForConversion() {
+  /*!
+    @brief     Wait until the current conversion has finished or timed out
+    @details   This is the blocking counterpart to poll() and the wait is bounded by the conversion
+               time plus DS_CONVERSION_OVERRUN milliseconds
+  */
+  DS_PROFILE_WAIT_START;
+  while (poll() == DS_CONVERSION_ACTIVE) {
+    yield();  // Allow background tasks to run
+  }           // of while conversion is active
+  DS_PROFILE_WAIT_END;
+}  // of method WaitForConversion()
+bool DSFamily_Class::DeviceConverting(const DSDeviceNumber deviceNumber) {
+  /*!
+    @brief     Check if the given device is still converting
+    @details   Devices beyond DS_MAX_TRACKED_DEVICES aren't tracked, so they are assumed to be busy
+               for as long as any conversion is active. The deadline is stored as the lower 16 bits
+               of millis(), which is unambiguous since poll() clears all flags once the overall
+               conversion time has passed
+    @param[in] deviceNumber 1-Wire device number
+    @return    "true" if the device is still converting
+  */
+  if (poll() != DS_CONVERSION_ACTIVE) return (false);          // Nothing is converting
+  if (deviceNumber >= DS_MAX_TRACKED_DEVICES) return (true);  // Untracked, assume busy
+  uint8_t mask = 1 << (deviceNumber & 7);                     // Bit in the busy flags
+  if (!(_DeviceConverting[deviceNumber >> 3] & mask)) return (false);
+  if ((int16_t)(_DeviceDeadline[deviceNumber] - (uint16_t)millis()) > 0) return (true);
+  _DeviceConverting[deviceNumber >> 3] &= ~mask;  // Deadline has passed
+  return (false);
+}  // of method DeviceConverting()
+void DSFamily_Class::StartDeviceDeadline(const DSDeviceNumber deviceNumber, const uint32_t now) {
+  /*!
+    @brief     Store the conversion deadline for a device that has just started converting
+    @param[in] deviceNumber 1-Wire device number
+    @param[in] now millis() value at the start of the conversion
+  */
+  if (deviceNumber < DS_MAX_TRACKED_DEVICES) {
+    _DeviceDeadline[deviceNumber] = now + DS_CONVERSION_TIME[TrackedResolution(deviceNumber) - 9];
+    _DeviceConverting[deviceNumber >> 3] |= 1 << (deviceNumber & 7);  // Set the busy flag
+  }  // if-then device is tracked
+}  // of method StartDeviceDeadline()
+uint8_t DSFamily_Class::TrackedResolution(const DSDeviceNumber deviceNumber) {
+  /*!
+    @brief     Return the resolution last set for a device
+    @details   The resolution is packed as 2 bits per device holding "12 - resolution", so that the
+               cleared array defaults to 12 bits. Untracked devices are assumed to use 12 bits
+    @param[in] deviceNumber 1-Wire device number
+    @return    Resolution in bits (9, 10, 11 or 12)
+  */
+  if (deviceNumber >= DS_MAX_TRACKED_DEVICES) return (12);  // Untracked, assume maximum
+  return (12 - ((_DeviceResolution[deviceNumber >> 2] >> ((deviceNumber & 3) << 1)) & 3));
+}  // of method TrackedResolution()
+void DSFamily_Class::SetTrackedResolution(const DSDeviceNumber deviceNumber,
+                                          const uint8_t        resolution) {
+  /*!
+    @brief     Store the resolution of a device in the packed resolution array
+    @param[in] deviceNumber 1-Wire device number
+    @param[in] resolution Resolution in bits (9, 10, 11 or 12)
+  */
+  if (deviceNumber < DS_MAX_TRACKED_DEVICES) {
+    uint8_t shift = (deviceNumber & 3) << 1;                             // Position of 2 bits
+    _DeviceResolution[deviceNumber >> 2] &= ~(3 << shift);               // Clear old value
+    _DeviceResolution[deviceNumber >> 2] |= (12 - resolution) << shift;  // and set new one
+  }  // if-then device is tracked
+}  // of method SetTrackedResolution()
 void DSFamily_Class::Calibrate(const uint8_t iterations, const int16_t CalTemp) {
   /*!
    @brief     Calibrate all thermometers
-   @details   Each DS has a persistent 2 user bytes which can be both read and updated.  These can
-              be used for triggering alarms, but in this application we are going to set these to
-              provide a calibration offset value so that all DS devices on the 1-wire can be set to
-              accurately show the same temperature. This only works when all of the thermometers are
-              at the same temperature, which can be done by various methods. What temperature is
-              used for the calibration is unimportant, although a calibration at typical operating
-              temperatures makes the most sense.\n\n The calibration method used here is quite
-              simple and straightforward. First, all devices are measured for a period of time
-              defined in MEASUREMENT_ITERATIONS. The average of all readings is computed and that
-              value is assumed to be the correct and accurate temperature reading. Each
-              thermometer's offset to this standard value is computed and is written to the two user
-              bytes.\n\n In order to ensure that the correct values are used at runtime, the values
-              are written to the two user bytes so that XOR'ing them together always results in a
-              value of 0xFF.\n\n The CalTemp optional parameter specifies the calibration
-              temperature that all thermometers are to be adjusted to. This temperature is a signed
-              integer in hectodegrees Celsius, so a temperature of "28.12" would be "2812".
+   @details   Each device gets a calibration offset in its ROM table entry so that all DS devices
+              on the 1-wire can be set to accurately show the same temperature. This only works
+              when all of the thermometers are at the same temperature, which can be done by various
+              methods. What temperature is used for the calibration is unimportant, although a
+              calibration at typical operating temperatures makes the most sense.\n\n The
+              readings are taken by CalibrationReadings(), which reads each sample while the next
+              one is being converted and leaves out readings far from the median of their sample.
+              The mean of the remaining readings of all devices is assumed to be the correct and
+              accurate temperature and each thermometer's offset to this value is stored in 1/16 of
+              a device unit. A gain set by CalibrateGain() is kept and applied to the readings
+              before the offset is computed.\n\n The CalTemp optional parameter specifies the
+              calibration temperature that all thermometers are to be adjusted to. This temperature
+              is a signed integer in hectodegrees Celsius, so a temperature of "28.12" would be
+              "2812".
    @param[in] iterations Number of calibration iterations to perform. The higher the value the more
               accurate the calibration is.
    @param[in] CalTemp (Optional) When specified, the given temperature is assumed to be the correct
               one and all thermometers are calibrated to that temperature, otherwise the average
-              reading is used as the calibrated temperature completed
-  */
-  const uint8_t DS_MAX_THERMOMETERS{32};            // Specify a maximum number here
-  int64_t       stats1[DS_MAX_THERMOMETERS] = {0};  // store statistics per device
-  int64_t       tempSum{0};                         // Stores interim values
-  int8_t        offset{0};                          // Stores the computed offset value
-  uint8_t       ThermometersUsed =
-      min(DS_MAX_THERMOMETERS, ThermometersFound);  // Use the lower of the 2 values
-  _LastCommandWasConvert = false;
-  for (uint8_t i = 0; i < iterations; i++)  // Loop to get a good sampling
-  {
-    for (uint8_t x = 0; x < ThermometersUsed; x++)  // process each thermometer
-    {
-      stats1[x] += ReadDeviceTemp(x, true);  // read raw temperature, no offset
-    }                                        // of for each thermometer loop
-    DeviceStartConvert();                    // Start conversion on all devices
-    delay(ConversionMillis);                 // Wait to complete measurements
-  }                                          // of for loop
-  for (uint8_t i = 0; i < ThermometersUsed; i++) {
-    tempSum += stats1[i];  // Add value to standard dev comps
-  }                        // for-next each thermometer
-  if (CalTemp == INT16_MAX) {
-    tempSum = (CalTemp * 10) / 625;  // Use specific target temperature
+              reading is used as the calibrated temperature
+  */
+  DS_PROFILE_CALL(DS_CALL_CALIBRATION);
+  if (ThermometersFound == 0) return;
+  int16_t *means = (int16_t *)malloc(ThermometersFound * sizeof(int16_t));  // Mean raw readings
+  if (means == nullptr) return;
+  int32_t        sum    = 0;  // Sum of the gain corrected means
+  DSDeviceNumber count  = 0;  // Number of means in the sum
+  int32_t        target = ((int32_t)CalTemp * 256 + (CalTemp < 0 ? -50 : 50)) / 100;  // 1/16
+  if (CalibrationReadings(iterations, means)) {
+    for (DSDeviceNumber i = 0; i < ThermometersFound; i++) {
+      if (means[i] == INT16_MIN) continue;  // No reading was kept
+      sum += means[i] + (((int32_t)means[i] * GetDeviceGain(i)) >> 16);
+      count++;
+    }  // of for-next each device
+  }    // if-then readings taken
+  if (count > 0 && CalTemp == INT16_MAX) {
+    target = (sum >= 0 ? sum + count / 2 : sum - count / 2) / count;  // Use the average
+  }  // if-then no calibration temperature specified
+  for (DSDeviceNumber i = 0; count > 0 && i < ThermometersFound; i++) {
+    if (means[i] == INT16_MIN) continue;  // Keep the old calibration
+    int16_t gain   = GetDeviceGain(i);
+    int32_t offset = target - means[i] - (((int32_t)means[i] * gain) >> 16);
+    offset         = max(min(offset, (int32_t)INT16_MAX), (int32_t)INT16_MIN);
+    SetDeviceCalibration(i, (int16_t)offset, gain);  // Store the new offset
+  }                                                  // of for-next each device
+  free(means);
+}  // of method Calibrate()
+DSDeviceNumber DSFamily_Class::CalibrateGain(const int16_t CalTemp, const int16_t firstCalTemp,
+                                             const uint8_t iterations) {
+  /*!
+   @brief     Add a gain to the calibration of all thermometers with a second known temperature
+   @details   Calibrate() at firstCalTemp has to be done first. With all thermometers now at the
+              different temperature CalTemp the readings are taken the same way and each device
+              gets the gain and offset which map both of its readings to the two temperatures. The
+              reading at the first temperature is derived from the stored calibration, so only the
+              temperature needs to be given again, a device without an offset is taken to have read
+              it exactly. The gain is stored in 1/65536 as the slope minus one. Devices with
+              readings less than 5°C apart or with a slope that isn't between 0.5 and 1.5 keep
+              their calibration
+   @param[in] CalTemp Temperature of all thermometers in hectodegrees Celsius, e.g. "2812" for
+              28.12°C
+   @param[in] firstCalTemp Temperature given to the preceding Calibrate() call
+   @param[in] iterations (Optional, default 30) Number of samples taken
+   @return    Number of devices that were calibrated
+  */
+  DS_PROFILE_CALL(DS_CALL_CALIBRATION);
+  DSDeviceNumber calibrated = 0;  // Devices with a new gain
+  if (ThermometersFound == 0) return (calibrated);
+  int16_t *means = (int16_t *)malloc(ThermometersFound * sizeof(int16_t));  // Mean raw readings
+  if (means == nullptr) return (calibrated);
+  int32_t high = ((int32_t)CalTemp * 256 + (CalTemp < 0 ? -50 : 50)) / 100;  // 1/16 units
+  int32_t low  = ((int32_t)firstCalTemp * 256 + (firstCalTemp < 0 ? -50 : 50)) / 100;
+  bool    read = CalibrationReadings(iterations, means);
+  for (DSDeviceNumber i = 0; read && i < ThermometersFound; i++) {
+    int16_t offset = GetDeviceOffset(i);
+    if (means[i] == INT16_MIN) continue;  // Nothing to compute it from
+    int32_t first = ((int64_t)(low - offset) << 16) / (65536L + GetDeviceGain(i));  // Raw reading
+    int32_t span  = means[i] - first;  // Raw difference between the two temperatures
+    if (abs(span) < DS_GAIN_SPAN) continue;
+    int64_t gain = ((int64_t)(high - low - span) << 16) / span;  // Slope minus one
+    if (gain > INT16_MAX || gain < INT16_MIN) continue;
+    int32_t correction = low - first - (((int64_t)first * gain) >> 16);
+    if (correction > INT16_MAX || correction < INT16_MIN) continue;
+    SetDeviceCalibration(i, (int16_t)correction, (int16_t)gain);
+    calibrated++;
+  }  // of for-next each device
+  free(means);
+  return (calibrated);
+}  // of method CalibrateGain()
+bool DSFamily_Class::CalibrationReadings(const uint8_t iterations, int16_t means[]) {
+  /*!
+    @brief      Take samples of all devices and return the mean raw reading of each device
+    @details    A device keeps the previous result in its scratchpad until a conversion finishes,
+                so unless parasitic devices block the bus the next conversion is started before the
+                readings of a sample are taken and each iteration takes a single conversion time.
+                The readings of each sample which are further from its median than 3 scaled median
+                absolute deviations, see RobustTemperature(), and also further than
+                DS_CALIBRATION_SPREAD are left out. The spread allows for the differences that the
+                calibration is meant to remove, the deviations catch readings that are off by more
+                than the devices usually disagree.\n\n All devices found take part. The working
+                storage of 9 bytes per device is taken from the heap for the duration of the call
+    @param[in]  iterations Number of samples
+    @param[out] means Mean raw reading of each of the ThermometersFound devices in 1/16 device
+                units, INT16_MIN if none of its readings was kept
+    @return     "false" if the working storage couldn't be allocated
+  */
+  DSDeviceNumber devices = ThermometersFound;
+  int32_t *sums = (int32_t *)malloc(devices * (sizeof(int32_t) + 2 * sizeof(int16_t) + 1));
+  if (sums == nullptr) return (false);
+  int16_t *readings = (int16_t *)(sums + devices);    // Readings of the current sample
+  int16_t *values   = readings + devices;             // Good readings, reordered for the median
+  uint8_t *counts   = (uint8_t *)(values + devices);  // Number of kept readings of each device
+  uint8_t  dsBuffer[9];
+  memset(sums, 0, devices * sizeof(int32_t));  // Sum of the kept readings of each device
+  memset(counts, 0, devices);                  // and their number
+  DeviceStartConvert();  // First sample
+  for (uint8_t k = 0; k < iterations; k++) {
+    WaitForConversion();
+    bool           next  = k + 1 < iterations;     // Another sample follows
+    DSDeviceNumber count = 0;                      // Good readings of the sample
+    if (next && !Parasitic) DeviceStartConvert();  // Converts while this sample is read
+    for (DSDeviceNumber i = 0; i < devices; i++) {
+      readings[i] = DS_BAD_TEMPERATURE;
+      if (Read1WireScratchpad(i, dsBuffer)) readings[i] = ScratchpadTemp(i, dsBuffer, true);
+      if (readings[i] != DS_BAD_TEMPERATURE) values[count++] = readings[i];
+    }                                             // of for-next each device
+    if (next && Parasitic) DeviceStartConvert();  // Bus was blocked until now
+    if (count == 0) continue;
+    int16_t median = MedianOf(values, count);
+    for (DSDeviceNumber i = 0; i < count; i++) values[i] = abs(values[i] - median);  // Deviations
+    uint32_t limit = ((uint32_t)MedianOf(values, count) * 3 * 1483 + 500) / 1000;
+    if (limit < DS_CALIBRATION_SPREAD) limit = DS_CALIBRATION_SPREAD;
+    for (DSDeviceNumber i = 0; i < devices; i++) {
+      if (readings[i] == DS_BAD_TEMPERATURE || (uint32_t)abs(readings[i] - median) > limit) {
+        continue;
+      }  // if-then reading left out
+      sums[i] += readings[i];
+      counts[i]++;
+    }  // of for-next each device
+  }    // of for-next each sample
+  for (DSDeviceNumber i = 0; i < devices; i++) {
+    int32_t sum = sums[i] * 16;  // In 1/16 device units
+    means[i]    = INT16_MIN;     // No reading was kept
+    if (counts[i]) means[i] = (sum >= 0 ? sum + counts[i] / 2 : sum - counts[i] / 2) / counts[i];
+  }  // of for-next each device
+  free(sums);
+  return (true);
+}  // of method CalibrationReadings()
+void DSFamily_Class::SetDeviceCalibration(const DSDeviceNumber deviceNumber, const int8_t offset) {
+  /*!
+    @brief     Set the calibration offset of a device in device units
+    @details   The offset is stored in the ROM table entry of the device, which leaves the TH and TL
+               bytes of the device free for the alarm limits and needs no NV write on the device.
+               A gain set by CalibrateGain() is kept. Only a changed value is written to the EEPROM
+    @param[in] deviceNumber 1-Wire device number
+    @param[in] offset Calibration value to set, INT8_MIN removes the calibration and the gain
+  */
+  if (offset == INT8_MIN) {
+    SetDeviceCalibration(deviceNumber, (int16_t)0, (int16_t)0);
   } else {
-    tempSum = tempSum / iterations / ThermometersUsed;  // Use computed average temperature
-  }  // if-then-else use specified calibration temperature
-  for (uint8_t i = 0; i < ThermometersUsed; i++)  // Loop for every thermometer found
-  {
-    offset = tempSum - (stats1[i] / iterations);  // Compute offset value from mean
-    SetDeviceCalibration(i, offset);              // Set the new user bytes 1&2
-  }                                               // of for-next all thermometers
-}  // of method CalibrateDS18B20
-void DSFamily_Class::SetDeviceCalibration(const uint8_t deviceNumber, const int8_t offset) {
-  /*!
-    @brief     Set the user bytes 1 and 2 to the calibration computed
-    @details   The calibration value is written to register 1 and register is written as the XOR'd
-               value of the the first register. This is done to check for an actual calibration
-               value rather than some other value that the user might have written to the device
+    SetDeviceCalibration(deviceNumber, (int16_t)(offset * 16), GetDeviceGain(deviceNumber));
+  }  // if-then-else remove the calibration
+}  // of method SetDeviceCalibration()
+void DSFamily_Class::SetDeviceCalibration(const DSDeviceNumber deviceNumber, const int16_t offset,
+                                          const int16_t gain) {
+  /*!
+    @brief     Set the calibration offset and gain of a device
+    @details   A reading r in device units is calibrated to r + r * gain / 65536 + offset / 16,
+               which is computed in fixed point and rounded. Only changed bytes are written to the
+               EEPROM
     @param[in] deviceNumber 1-Wire device number
-    @param[in] offset Calibration value to set
+    @param[in] offset Offset in 1/16 device units, 0 for none
+    @param[in] gain Slope minus one in 1/65536, 0 for none
   */
-  uint8_t dsBuffer[9];
-  _LastCommandWasConvert = false;
-  Read1WireScratchpad(deviceNumber, dsBuffer);  // Read from the device scratchpad
-  SelectDevice(deviceNumber);                   // Reset 1-wire, address device
-  write_byte(DS_WRITE_SCRATCHPAD);              // Write scratchpad, send 3 bytes
-  write_byte(offset);                           // Write user Byte 1
-  write_byte(offset ^ 0xFF);                    // Write the XOR'd value user Byte 1
-  write_byte(dsBuffer[DS_CONFIG_BYTE]);         // Set configuration register back
-  write_byte(DS_COPY_SCRATCHPAD);               // Copy scratchpad values to NV memory
-  delay(DS_MAX_NV_CYCLE_TIME);                  // Give the DS18x20 time to process
+  DS_PROFILE_CALL(DS_CALL_CALIBRATION);
+  if (deviceNumber >= ThermometersFound) return;
+  SnapshotValid = false;  // Calibrated values will change
+  WriteEntryWord(deviceNumber, DS_ROM_CALIBRATION, offset);
+  WriteEntryWord(deviceNumber, DS_ROM_GAIN, gain);
 }  // of method SetDeviceCalibration()
-int8_t DSFamily_Class::GetDeviceCalibration(const uint8_t deviceNumber) {
+int8_t DSFamily_Class::GetDeviceCalibration(const DSDeviceNumber deviceNumber) {
   /*!
-    @brief     Return the calibration setting from the device
-    @details   If the calibration register 1 is equal to the XOR value of register 2 then it is
-               assumed that a valid calibration has been set and that is returned
+    @brief     Return the calibration offset of a device in device units
+    @details   The offset is read from the ROM table and rounded to device units, use
+               GetDeviceOffset() for the exact value
     @param[in] deviceNumber 1-Wire device number
-    @return    calibration offset. If the calibration offset is invalid then INT8_MIN is returned
-  */
-  int8_t  offset = INT8_MIN;                    // Default to an invalid value
-  uint8_t dsBuffer[9];                          // Temporary scratchpad buffer
-  _LastCommandWasConvert = false;               // Set switch to false
-  Read1WireScratchpad(deviceNumber, dsBuffer);  // Read from the device scratchpad
-  if ((dsBuffer[2] ^ dsBuffer[3]) == 0xFF) {
-    offset = (int8_t)dsBuffer[2];
-  }  // if-then a valid calibration
-  return (offset);
+    @return    calibration offset, 0 if the device has none. INT8_MIN for an unknown device
+  */
+  DS_PROFILE_CALL(DS_CALL_CALIBRATION);
+  if (deviceNumber >= ThermometersFound) return (INT8_MIN);
+  int32_t exact = ReadEntryWord(deviceNumber, DS_ROM_CALIBRATION);  // 1/16 device units
+  exact         = (exact >= 0 ? exact + 8 : exact - 8) / 16;
+  return (max(min(exact, (int32_t)INT8_MAX), (int32_t)(INT8_MIN + 1)));
 }  // of method GetDeviceCalibration()
-void DSFamily_Class::SelectDevice(const uint8_t deviceNumber) {
+int16_t DSFamily_Class::GetDeviceOffset(const DSDeviceNumber deviceNumber) {
+  /*!
+    @brief     Return the calibration offset of a device as stored in the ROM table
+    @param[in] deviceNumber 1-Wire device number
+    @return    Offset in 1/16 device units, 0 if the device has none, INT16_MIN for an unknown
+               device
+  */
+  if (deviceNumber >= ThermometersFound) return (INT16_MIN);
+  return (ReadEntryWord(deviceNumber, DS_ROM_CALIBRATION));
+}  // of method GetDeviceOffset()
+int16_t DSFamily_Class::GetDeviceGain(const DSDeviceNumber deviceNumber) {
+  /*!
+    @brief     Return the calibration gain of a device
+    @param[in] deviceNumber 1-Wire device number
+    @return    Slope minus one in 1/65536, 0 if the device has no gain calibration
+  */
+  if (deviceNumber >= ThermometersFound) return (0);
+  return (ReadEntryWord(deviceNumber, DS_ROM_GAIN));
+}  // of method GetDeviceGain()
+void DSFamily_Class::SetDeviceAlarm(const DSDeviceNumber deviceNumber, const int8_t low,
+                                    const int8_t high) {
+  /*!
+    @brief     Set the TL and TH alarm limits of one or all devices
+    @details   After each conversion a device whose reading is at or below TL or at or above TH
+               answers AlarmSearch(). The limits are in whole °C and copied to the NV memory of the
+               devices, with a single broadcast COPY SCRATCHPAD when several devices are changed on
+               a bus of thermometers only, otherwise with one copy and NV write cycle per device.
+               Devices which already have the limits aren't written to
+    @param[in] deviceNumber 1-Wire device number, DS_ALL_DEVICES for all devices
+    @param[in] low Lowest temperature without an alarm plus one, i.e. TL
+    @param[in] high Highest temperature without an alarm minus one, i.e. TH
+  */
+  DS_PROFILE_CALL(DS_CALL_ALARM);
+  uint8_t        dsBuffer[9];
+  DSDeviceNumber first   = deviceNumber;  // First device to set
+  DSDeviceNumber last    = deviceNumber;  // Last device to set
+  DSDeviceNumber changed   = deviceNumber;  // Last device whose scratchpad was written
+  DSDeviceNumber written   = 0;             // Number of scratchpads written
+  bool           broadcast = deviceNumber == DS_ALL_DEVICES && !_OtherDevices;
+  _LastCommandWasConvert   = false;
+  if (deviceNumber == DS_ALL_DEVICES) {
+    first = 0;
+    last  = ThermometersFound - 1;
+  }  // if-then all devices
+  if (ThermometersFound == 0 || last >= ThermometersFound) return;
+  for (DSDeviceNumber i = first;; i++) {
+    if (Read1WireScratchpad(i, dsBuffer) &&
+        WriteScratchpad(i, dsBuffer, high, low, dsBuffer[DS_CONFIG_BYTE])) {
+      written++;
+      changed = i;                        // Remember for a single copy
+      if (!broadcast) CopyScratchpad(i);  // Other devices must not receive the copy
+    }                                     // if-then scratchpad changed
+    if (i == last) break;
+  }  // for-next each device
+  if (written && broadcast) {
+    CopyScratchpad(written == 1 ? changed : DS_ALL_DEVICES);  // One NV write cycle for all
+  }  // if-then store the whole bus at once
+}  // of method SetDeviceAlarm()
+DSDeviceNumber DSFamily_Class::AlarmSearch(DSDeviceNumber       devices[],
+                                           const DSDeviceNumber maxDevices) {
+  /*!
+    @brief     Find the devices whose last reading is outside of their alarm limits
+    @details   Uses the ALARM SEARCH command, to which only devices in an alarm state answer, so
+               finding that no device is out of range takes a single search pass of one reset and
+               192 slots instead of a scratchpad read of each device. The addresses found are
+               looked up in the ROM table. If a conversion is running then it is waited for first.
+               Only the devices found need to be read with ReadDeviceTemp() afterwards
+    @param[out] devices Device numbers of the devices in an alarm state, in search order
+    @param[in] maxDevices Size of the devices array
+    @return    Number of devices in an alarm state, which might be more than maxDevices
+  */
+  DS_PROFILE_CALL(DS_CALL_ALARM);
+  uint8_t        rom[8], stored[8];
+  DSDeviceNumber found = 0;  // Number of alarming devices
+  WaitForConversion();
+  _LastCommandWasConvert = false;
+  reset_search();
+  while (search(rom, DS_ALARM_SEARCH)) {
+    for (DSDeviceNumber i = 0; i < ThermometersFound; i++) {
+      ReadRomEntry(i, stored);
+      if (memcmp(rom, stored, 8) == 0) {
+        if (found < maxDevices) devices[found] = i;
+        found++;
+        break;
+      }  // if-then device is in the table
+    }    // for-next each stored device
+  }      // of while alarming devices are found
+  return (found);
+}  // of method AlarmSearch()
+bool DSFamily_Class::WriteScratchpad(const DSDeviceNumber deviceNumber, const uint8_t current[9],
+                                     const uint8_t userByte1, const uint8_t userByte2,
+                                     const uint8_t config) {
+  /*!
+    @brief     Write the user bytes and configuration to a device's scratchpad if they changed
+    @details   Only the resolution bits of the configuration are compared, and only the user bytes
+               on a DS18S20 which has no configuration register. Nothing is written to NV memory,
+               use CopyScratchpad() once all devices have been written
+    @param[in] deviceNumber 1-Wire device number
+    @param[in] current Scratchpad contents just read from the device
+    @param[in] userByte1 New value for user byte 1 (TH)
+    @param[in] userByte2 New value for user byte 2 (TL)
+    @param[in] config New configuration register value
+    @return    "true" if the scratchpad was written
+  */
+  if (current[DS_USER_BYTE_1] == userByte1 && current[DS_USER_BYTE_2] == userByte2 &&
+      (ROM_NO[0] == DS18S20_FAMILY || ((current[DS_CONFIG_BYTE] ^ config) & 0x60) == 0)) {
+    return (false);  // Already holds the values
+  }                  // if-then unchanged
+  SelectDevice(deviceNumber);       // Reset 1-wire, address device
+  write_byte(DS_WRITE_SCRATCHPAD);  // Write scratchpad, send 3 bytes
+  write_byte(userByte1);            // User byte 1
+  write_byte(userByte2);            // User byte 2
+  write_byte(config);               // Configuration register
+  return (true);
+}  // of method WriteScratchpad()
+void DSFamily_Class::CopyScratchpad(const DSDeviceNumber deviceNumber) {
+  /*!
+    @brief     Copy the scratchpad of one or all devices to their NV memory and wait for it
+    @details   With DS_ALL_DEVICES a single Skip ROM COPY SCRATCHPAD is sent to all devices on the
+               bus, so any number of devices only take one NV write cycle. Other 1-Wire devices
+               give the 0x48 command a meaning of their own, e.g. the DS2438 copies its scratchpad
+               page, so the callers only broadcast it when the last search found thermometers
+               alone and every one of them is being written. The scratchpads of
+               devices whose resolution SetAdaptiveResolution() has lowered hold their own
+               resolution during the copy, so that only that one is stored
+    @param[in] deviceNumber 1-Wire device number, DS_ALL_DEVICES for all devices
+  */
+#if DS_ADAPTIVE_RESOLUTION > 0
+  WriteAdaptedResolutions(deviceNumber, false);  // Store the own resolution of lowered devices
+#endif
+  if (deviceNumber == DS_ALL_DEVICES) {
+    ParasiticWait();          // Wait for conversion if necessary
+    bus_reset();              // Reset 1-wire network
+    write_byte(DS_SKIP_ROM);  // Tell all devices to listen
+  } else {
+    SelectDevice(deviceNumber);  // Reset 1-wire, address device
+  }                              // if-then-else all devices
+  write_byte(DS_COPY_SCRATCHPAD);  // Copy scratchpad to NV memory
+  DS_PROFILE_WAIT_START;
+  delay(DS_MAX_NV_CYCLE_TIME);  // Give the DS18x20 time to process
+  DS_PROFILE_WAIT_END;
+#if DS_ADAPTIVE_RESOLUTION > 0
+  WriteAdaptedResolutions(deviceNumber, true);  // and lower them again
+#endif
+}  // of method CopyScratchpad()
+void DSFamily_Class::SelectDevice(const DSDeviceNumber deviceNumber) {
   /*!
    @brief     reset the 1-Wire microLAN and select the device number specified
    @param[in] deviceNumber 1-Wire device number
   */
-  ParasiticWait();  // Wait for conversion if necessary
-  for (uint8_t i = 0; i < 8; i++) {
-    ROM_NO[i] = EEPROM.read(i + E2END - ((deviceNumber + 1) * 8));  // Read the EEPROM byte
-  }                // for-next each byte of the buffer
-  reset();         // Reset 1-wire communications
-  select(ROM_NO);  // Select only current device
+  ParasiticWait();                     // Wait for conversion if necessary
+  ReadRomEntry(deviceNumber, ROM_NO);  // Get the device address
+  bus_reset();                         // Reset 1-wire communications
+  select(ROM_NO);                      // Select only current device
 }  // of method SelectDevice()
-void DSFamily_Class::GetDeviceROM(const uint8_t deviceNumber, uint8_t ROMBuffer[8]) {
+void DSFamily_Class::GetDeviceROM(const DSDeviceNumber deviceNumber, uint8_t ROMBuffer[8]) {
   /*!
     @brief      return the 8-byte ROM address buffer
     @param[in]  deviceNumber 1-Wire device number
     @param[out] ROMBuffer 8-byte ROM address buffer of device
   */
   _LastCommandWasConvert = false;
-  for (uint8_t i = 0; i < 8; i++) {
-    ROMBuffer[i] = EEPROM.read(i + E2END - ((deviceNumber + 1) * 8));
-  }  // for-next each byte in the buffer
+  ReadRomEntry(deviceNumber, ROMBuffer);
 }  // of method GetDeviceROM()
-int16_t DSFamily_Class::MinTemperature(uint8_t skipDeviceNumber) {
+void DSFamily_Class::ReadRomEntry(const DSDeviceNumber deviceNumber, uint8_t rom[8]) {
+  /*!
+    @brief      Get the ROM address of a device from the RAM cache or the EEPROM table
+    @details    With a full cache the address is copied directly. Otherwise the cache entries are
+                searched, a hit is moved to the front and a miss is read from EEPROM and replaces
+                the least recently used entry
+    @param[in]  deviceNumber 1-Wire device number
+    @param[out] rom 8-byte ROM address of the device
+  */
+#if DS_ROM_CACHE_SIZE > 0
+  uint8_t entry;
+  if (_RomCacheFull && deviceNumber < DS_ROM_CACHE_SIZE) {
+    memcpy(rom, _RomCache[deviceNumber], 8);  // Entry n holds device n
+    return;
+  }  // if-then all devices are cached
+  for (entry = 0; entry < DS_ROM_CACHE_SIZE - 1; entry++) {
+    if (_RomCacheDevice[entry] == deviceNumber) break;
+  }  // for-next each entry, the last one is replaced on a miss
+  if (_RomCacheDevice[entry] != deviceNumber) {  // Not cached, so read from EEPROM
+    for (uint8_t i = 0; i < 8; i++) {
+      _RomCache[entry][i] = EEPROM.read(RomEntryAddress(deviceNumber) + i);
+    }  // for-next each byte of the address
+  }    // if-then cache miss
+  memcpy(rom, _RomCache[entry], 8);
+  memmove(_RomCache[1], _RomCache[0], entry * 8);  // Move the entries in front down by one
+  memmove(&_RomCacheDevice[1], &_RomCacheDevice[0], entry * sizeof(DSDeviceNumber));
+  memcpy(_RomCache[0], rom, 8);  // and place this device at the front
+  _RomCacheDevice[0] = deviceNumber;
+#else
+  for (uint8_t i = 0; i < 8; i++) {
+    rom[i] = EEPROM.read(RomEntryAddress(deviceNumber) + i);  // Read the EEPROM byte
+  }  // for-next each byte of the address
+#endif
+}  // of method ReadRomEntry()
+bool DSFamily_Class::WriteRomEntry(const DSDeviceNumber deviceNumber, const uint8_t rom[8]) {
+  /*!
+    @brief      Store the ROM address of a device in the EEPROM table and the RAM cache
+    @details    This is the only place entries are written, which keeps the cache coherent: the
+                entry holding the device is updated wherever it is in the cache, and a device which
+                doesn't fit into the cache ends the mode in which entry n holds device n. Bytes
+                that already hold the correct value aren't written, saving EEPROM write cycles. The
+                group bits and the calibration belong to the device, so they are cleared when the
+                address changes; otherwise the calibration and gain are loaded into their RAM copies
+    @param[in]  deviceNumber 1-Wire device number
+    @param[in]  rom 8-byte ROM address of the device
+    @return     "true" if the entry held a different device, which now has a cleared entry
+  */
+  bool    changed = false;                    // A different device is stored
+  uint8_t mask    = 1 << (deviceNumber & 7);  // Bit in the removed flags
+  if (crc8(rom, 7) != rom[7]) {
+    _DeviceRemoved[deviceNumber >> 3] |= mask;  // Inverted CRC byte
+  } else {
+    _DeviceRemoved[deviceNumber >> 3] &= ~mask;
+  }  // if-then-else removed device
+  for (uint8_t i = 0; i < 8; i++) {
+    if (EEPROM.read(RomEntryAddress(deviceNumber) + i) != rom[i]) {
+      EEPROM.write(RomEntryAddress(deviceNumber) + i, rom[i]);  // Write the EEPROM byte
+      if (i < 7) changed = true;  // Only the CRC differs for a removed device
+    }                             // if-then byte differs
+  }                               // for-next each byte of the address
+  if (changed) {
+    EEPROM.update(RomEntryAddress(deviceNumber) + DS_ROM_GROUPS, 0);  // No groups
+    WriteEntryWord(deviceNumber, DS_ROM_CALIBRATION, 0);              // no offset
+    WriteEntryWord(deviceNumber, DS_ROM_GAIN, 0);                     // and no gain
+  } else if (deviceNumber < DS_MAX_TRACKED_DEVICES) {
+    uint16_t address = RomEntryAddress(deviceNumber) + DS_ROM_CALIBRATION;
+    _DeviceOffset[deviceNumber] = EEPROM.read(address) | (EEPROM.read(address + 1) << 8);
+    address = RomEntryAddress(deviceNumber) + DS_ROM_GAIN;
+    _DeviceGain[deviceNumber] = EEPROM.read(address) | (EEPROM.read(address + 1) << 8);
+  }  // if-then-else a different device, or load the RAM copies
+#if DS_ROM_CACHE_SIZE > 0
+  if (_RomCacheFull && deviceNumber < DS_ROM_CACHE_SIZE) {
+    memcpy(_RomCache[deviceNumber], rom, 8);  // Entry n holds device n
+    _RomCacheDevice[deviceNumber] = deviceNumber;
+  } else {
+    if (deviceNumber >= DS_ROM_CACHE_SIZE) _RomCacheFull = false;  // Not all devices fit now
+    for (uint8_t entry = 0; entry < DS_ROM_CACHE_SIZE; entry++) {
+      if (_RomCacheDevice[entry] == deviceNumber) memcpy(_RomCache[entry], rom, 8);
+    }  // for-next each entry, whichever holds the device is updated
+  }    // if-then-else all devices are cached
+#endif
+  return (changed);
+}  // of method WriteRomEntry()
+bool DSFamily_Class::EntryHoldsDevice(const DSDeviceNumber entry, const uint8_t rom[8]) {
+  /*!
+    @brief      Check if a ROM table entry holds a device, directly in the EEPROM
+    @details    The CRC byte isn't compared, so the entry of a removed device matches as well
+    @param[in]  entry Entry number
+    @param[in]  rom 8-byte ROM address of the device
+    @return     "true" if the entry holds the address
+  */
+  for (uint8_t i = 0; i < 7; i++) {
+    if (EEPROM.read(RomEntryAddress(entry) + i) != rom[i]) return (false);
+  }  // for-next each byte of the address
+  return (true);
+}  // of method EntryHoldsDevice()
+void DSFamily_Class::SwapRomEntries(const DSDeviceNumber first, const DSDeviceNumber second) {
+  /*!
+    @brief      Exchange two ROM table entries in the EEPROM
+    @details    Only used by ScanForDevices() for entries which are neither cached nor loaded into
+                RAM yet, WriteRomEntry() then takes them over. Unchanged bytes aren't written
+    @param[in]  first Entry number
+    @param[in]  second Entry number
+  */
+  if (first == second) return;
+  for (uint8_t i = 0; i < DS_ROM_ENTRY_SIZE; i++) {
+    uint8_t value = EEPROM.read(RomEntryAddress(first) + i);
+    EEPROM.update(RomEntryAddress(first) + i, EEPROM.read(RomEntryAddress(second) + i));
+    EEPROM.update(RomEntryAddress(second) + i, value);
+  }  // for-next each byte of the entries
+}  // of method SwapRomEntries()
+void DSFamily_Class::ImportCalibration(const DSDeviceNumber deviceNumber) {
+  /*!
+    @brief      Move a calibration stored by an older version of the library into the ROM table
+    @details    Older versions kept the offset in device units in TH, with TL holding its inverse.
+                This is only checked once, when a device gets a new table entry; from then on TH
+                and TL are the alarm limits and the entry alone holds the calibration
+    @param[in]  deviceNumber 1-Wire device number
+  */
+  uint8_t dsBuffer[9];
+  if (Read1WireScratchpad(deviceNumber, dsBuffer) &&
+      (dsBuffer[DS_USER_BYTE_1] ^ dsBuffer[DS_USER_BYTE_2]) == 0xFF) {
+    WriteEntryWord(deviceNumber, DS_ROM_CALIBRATION, (int8_t)dsBuffer[DS_USER_BYTE_1] * 16);
+  }  // if-then an old calibration is in TH and TL
+}  // of method ImportCalibration()
+uint16_t DSFamily_Class::RomEntryAddress(const DSDeviceNumber deviceNumber) {
+  /*!
+    @brief      Return the EEPROM address of a ROM table entry
+    @details    The entries are stored downwards from the table header, which is at the end of
+                the EEPROM unless SetRomRegion() has moved it
+    @param[in]  deviceNumber 1-Wire device number
+    @return     Address of the first byte of the entry
+  */
+  return (_RomTableEnd - ((deviceNumber + 1) * DS_ROM_ENTRY_SIZE));
+}  // of method RomEntryAddress()
+int16_t DSFamily_Class::ReadEntryWord(const DSDeviceNumber deviceNumber, const uint8_t offset) {
+  /*!
+    @brief      Read a 16 bit value from a ROM table entry
+    @details    The calibration and gain of the tracked devices are read from their RAM copies,
+                since ScratchpadTemp() needs both for every reading
+    @param[in]  deviceNumber 1-Wire device number
+    @param[in]  offset Position of the value in the entry, stored low byte first
+    @return     Value read
+  */
+  if (deviceNumber < DS_MAX_TRACKED_DEVICES) {
+    if (offset == DS_ROM_CALIBRATION) return (_DeviceOffset[deviceNumber]);
+    if (offset == DS_ROM_GAIN) return (_DeviceGain[deviceNumber]);
+  }  // if-then value is kept in RAM
+  uint16_t address = RomEntryAddress(deviceNumber) + offset;
+  return ((int16_t)(EEPROM.read(address) | (EEPROM.read(address + 1) << 8)));
+}  // of method ReadEntryWord()
+void DSFamily_Class::WriteEntryWord(const DSDeviceNumber deviceNumber, const uint8_t offset,
+                                    const int16_t value) {
+  /*!
+    @brief      Write a 16 bit value to a ROM table entry, skipping bytes that don't change
+    @details    The RAM copies of the calibration and gain are updated as well
+    @param[in]  deviceNumber 1-Wire device number
+    @param[in]  offset Position of the value in the entry, stored low byte first
+    @param[in]  value Value to write
+  */
+  uint16_t address = RomEntryAddress(deviceNumber) + offset;
+  EEPROM.update(address, value & 0xFF);
+  EEPROM.update(address + 1, (uint16_t)value >> 8);
+  if (deviceNumber < DS_MAX_TRACKED_DEVICES) {
+    if (offset == DS_ROM_CALIBRATION) _DeviceOffset[deviceNumber] = value;
+    if (offset == DS_ROM_GAIN) _DeviceGain[deviceNumber] = value;
+  }  // if-then value is kept in RAM
+}  // of method WriteEntryWord()
+void DSFamily_Class::WriteRomHeader() {
+  /*!
+    @brief      Write the ROM table header for the current number of devices
+    @details    While ThermometersFound is 0 the header marks an empty table, which is never loaded.
+                The count has 16 bits, low byte first, so that the layout is the same for all
+                settings of DS_MAX_DEVICES. The flags byte records whether the last search found
+                devices other than thermometers, so a warm start knows it without a search
+  */
+  uint8_t header[DS_TABLE_HEADER_SIZE]{DS_TABLE_MAGIC, DS_TABLE_LAYOUT,
+                                       (uint8_t)ThermometersFound,
+                                       (uint8_t)((uint16_t)ThermometersFound >> 8),
+                                       (uint8_t)(_OtherDevices ? DS_TABLE_OTHER_DEVICES : 0), 0};
+  header[5] = crc8(header, 5);
+  for (uint8_t i = 0; i < DS_TABLE_HEADER_SIZE; i++) {
+    EEPROM.update(_RomTableEnd + i, header[i]);  // Only changed bytes are written
+  }  // for-next each header byte
+}  // of method WriteRomHeader()
+DSDeviceNumber DSFamily_Class::StoredDevices() {
+  /*!
+    @brief      Return the number of entries in the ROM table stored in the EEPROM
+    @details    The header must match the current layout and have a valid CRC
+    @return     Number of entries, 0 if there is no usable table
+  */
+  uint8_t header[DS_TABLE_HEADER_SIZE];
+  for (uint8_t i = 0; i < DS_TABLE_HEADER_SIZE; i++) {
+    header[i] = EEPROM.read(_RomTableEnd + i);
+  }  // for-next each header byte
+  uint16_t count = header[2] | (header[3] << 8);  // Number of stored devices
+  if (header[0] != DS_TABLE_MAGIC || header[1] != DS_TABLE_LAYOUT || crc8(header, 5) != header[5] ||
+      count > _MaxThermometers) {
+    return (0);
+  }  // if-then header invalid
+  return (count);
+}  // of method StoredDevices()
+bool DSFamily_Class::LoadRomTable() {
+  /*!
+    @brief      Use the ROM table stored by an earlier ScanForDevices() instead of searching
+    @details    The header must match the current layout and have a valid CRC, every entry must
+                have a valid ROM CRC and every device must return a valid scratchpad. The tracked
+                resolution of each device is taken from its scratchpad. The scratchpad is read once
+                without retries, and only if that fails verify() tells a missing device, which ends
+                the load, from a bad CRC, after which the read is repeated as usual. Entries of
+                devices which RescanDevices() found to be removed are kept without being checked
+    @return     "true" if all stored devices were confirmed, otherwise "false" and no devices
+  */
+  uint8_t        rom[8];
+  DSDeviceNumber count = StoredDevices();  // Number of stored devices
+  if (count == 0) return (false);          // No usable table
+  ClearRomCache();
+  ThermometersFound = count;  // Needed to read the devices
+  ConversionMillis  = DS_9b_CONVERSION_TIME;
+  _OtherDevices     = EEPROM.read(_RomTableEnd + 4) & DS_TABLE_OTHER_DEVICES;
+  DSDeviceNumber deviceNumber = 0;
+  for (; deviceNumber < count; deviceNumber++) {
+    for (uint8_t i = 0; i < 8; i++) {
+      rom[i] = EEPROM.read(RomEntryAddress(deviceNumber) + i);
+    }  // for-next each byte of the address
+    if (crc8(rom, 7) != rom[7] && crc8(rom, 7) != (rom[7] ^ 0xFF)) break;  // Entry is corrupt
+    WriteRomEntry(deviceNumber, rom);           // Unchanged in EEPROM, loads the calibration
+    if (DeviceRemoved(deviceNumber)) continue;  // Kept without a check
+    _SweepRetriesLeft = 0;                      // Read once, without retries
+    bool confirmed    = ConfirmDevice(deviceNumber);
+    _SweepRetriesLeft = UINT8_MAX;
+    if (!confirmed && verify(rom)) confirmed = ConfirmDevice(deviceNumber);  // Retry if present
+    if (!confirmed) break;                                                   // Device is missing
+  }  // for-next each stored device
+  if (deviceNumber < count) {
+    ClearRomCache();
+    ThermometersFound = 0;
+    return (false);
+  }  // if-then an entry can't be used
+  return (true);
+}  // of method LoadRomTable()
+void DSFamily_Class::ClearRomCache() {
+  /*!
+    @brief      Invalidate all RAM cache entries, e.g. before the EEPROM table is rebuilt
+  */
+#if DS_ROM_CACHE_SIZE > 0
+  memset(_RomCacheDevice, UINT8_MAX, sizeof(_RomCacheDevice));
+  _RomCacheFull = false;
+#endif
+}  // of method ClearRomCache()
+void DSFamily_Class::FillRomCache() {
+  /*!
+    @brief      Load the whole ROM table into the RAM cache if all devices fit
+    @details    Called once the table is complete after a scan or rescan. Entry n then holds
+                device n, so ReadRomEntry() needs no search. This is also a valid state of the LRU
+                cache, which takes over as soon as a device beyond DS_ROM_CACHE_SIZE is added
+  */
+#if DS_ROM_CACHE_SIZE > 0
+  if (ThermometersFound == 0 || ThermometersFound > DS_ROM_CACHE_SIZE) return;
+  for (uint8_t entry = 0; entry < DS_ROM_CACHE_SIZE; entry++) {
+    _RomCacheDevice[entry] = entry < ThermometersFound ? entry : DS_ALL_DEVICES;
+    for (uint8_t i = 0; entry < ThermometersFound && i < 8; i++) {
+      _RomCache[entry][i] = EEPROM.read(RomEntryAddress(entry) + i);
+    }  // for-next each byte of the address
+  }    // for-next each entry
+  _RomCacheFull = true;
+#endif
+}  // of method FillRomCache()
+void DSFamily_Class::SetRomRegion(const uint16_t endAddress, const DSDeviceNumber maxDevices) {
+  /*!
+    @brief      Place the ROM table in its own region of the EEPROM
+    @details    By default every instance keeps its table at the end of the EEPROM, so when several
+                buses are used in one program each one needs a separate region or they overwrite
+                each other's tables. The region holds the header and maxDevices entries and ends
+                directly below endAddress, DS_TABLE_HEADER_SIZE + maxDevices * DS_ROM_ENTRY_SIZE
+                bytes in all. Call this before ScanForDevices(), the devices found so far are
+                forgotten. An endAddress too low for the header leaves room for no devices
+    @param[in]  endAddress First EEPROM address above the region, E2END + 1 for the default
+    @param[in]  maxDevices Number of ROM table entries in the region, at most DS_MAX_DEVICES
+  */
+  if (endAddress < DS_TABLE_HEADER_SIZE) {
+    _RomTableEnd = 0;  // No room below the header
+  } else {
+    _RomTableEnd = endAddress - DS_TABLE_HEADER_SIZE;
+  }  // if-then-else region too small
+  uint16_t entries = _RomTableEnd / DS_ROM_ENTRY_SIZE;  // Entries that fit below the header
+  if (entries > maxDevices) entries = maxDevices;
+  if (entries > DS_MAX_DEVICES) entries = DS_MAX_DEVICES;
+  _MaxThermometers  = entries;
+  ThermometersFound = 0;
+  SnapshotValid     = false;
+  ClearRomCache();
+}  // of method SetRomRegion()
+void DSFamily_Class::SetDeviceGroups(const DSDeviceNumber deviceNumber, const uint8_t groups) {
+  /*!
+    @brief      Set the groups a device belongs to
+    @details    The group bits are stored in the ROM table entry of the device, so they are kept
+                by a warm start and by a scan which finds the same device at the same place. Only
+                a changed value is written to the EEPROM
+    @param[in]  deviceNumber 1-Wire device number
+    @param[in]  groups Bit n set for membership of group n, 0 for none
+  */
+  if (deviceNumber < ThermometersFound) {
+    EEPROM.update(RomEntryAddress(deviceNumber) + DS_ROM_GROUPS, groups);
+  }  // if-then device exists
+}  // of method SetDeviceGroups()
+uint8_t DSFamily_Class::GetDeviceGroups(const DSDeviceNumber deviceNumber) {
+  /*!
+    @brief      Return the groups a device belongs to
+    @param[in]  deviceNumber 1-Wire device number
+    @return     Bit n set for membership of group n, 0 for none or for unknown devices
+  */
+  if (deviceNumber >= ThermometersFound) return (0);
+  return (EEPROM.read(RomEntryAddress(deviceNumber) + DS_ROM_GROUPS));
+}  // of method GetDeviceGroups()
+void DSFamily_Class::SetGroupResolution(const uint8_t groups, const uint8_t resolution) {
+  /*!
+    @brief      Set the resolution of all devices in one or more groups
+    @details    Works like SetDeviceResolution() for all devices, but devices outside of the groups
+                aren't touched. As a broadcast COPY SCRATCHPAD would reach them as well, each
+                changed member is copied to its NV memory on its own, at the cost of one NV write
+                cycle (DS_MAX_NV_CYCLE_TIME, 100ms) per device
+    @param[in]  groups Bit n set to include group n
+    @param[in]  resolution Device resolution in bits: 9, 10, 11 or 12
+  */
+  DS_PROFILE_CALL(DS_CALL_GROUPS);
+  if (groups != 0 && ThermometersFound > 0) {
+    WriteResolutions(0, ThermometersFound - 1, groups, resolution);
+  }  // if-then any devices
+}  // of method SetGroupResolution()
+#if DS_GROUP_COUNT > 0
+void DSFamily_Class::SetGroupPeriod(const uint8_t group, const uint16_t periodMillis) {
+  /*!
+    @brief      Set how often ServiceGroups() samples a group
+    @details    The first conversion of the group is started by the next call to ServiceGroups()
+    @param[in]  group Group number, 0 to DS_GROUP_COUNT - 1
+    @param[in]  periodMillis Milliseconds from the start of one conversion to the next, 0 to stop
+  */
+  if (group >= DS_GROUP_COUNT) return;
+  _GroupPeriod[group] = periodMillis;
+  _GroupDue[group]    = millis();
+  _GroupConverting &= ~(1 << group);
+}  // of method SetGroupPeriod()
+uint8_t DSFamily_Class::ServiceGroups() {
+  /*!
+    @brief      Sample the groups whose period has passed, call repeatedly from loop()
+    @details    For each scheduled group this either starts the conversion of its members when the
+                group is due, or reads the members and replaces the statistics of the group once
+                their conversions are done; otherwise it returns at once. Only the members are
+                addressed, each one with its own CONVERT T, so the other groups are left alone and
+                a fast group at low resolution can be sampled while a slow one is converting. When
+                parasitic devices are present the bus must not be used during a conversion, so all
+                devices are started together instead. A device in several groups is read for each
+                of them
+    @return     Bit n set if the statistics of group n were updated by this call
+  */
+  DS_PROFILE_CALL(DS_CALL_GROUPS);
+  uint8_t updated = 0;  // Groups read in this call
+  for (uint8_t group = 0; group < DS_GROUP_COUNT; group++) {
+    uint8_t mask = 1 << group;  // Bit of the group
+    if (_GroupConverting & mask) {
+      bool busy = false;  // A member is still converting
+      for (DSDeviceNumber i = 0; i < ThermometersFound && !busy; i++) {
+        busy = (GetDeviceGroups(i) & mask) && DeviceConverting(i);
+      }  // of for-next each device
+      if (busy) continue;
+      _GroupStats[group].clear();
+      _SweepRetriesLeft = _SweepRetries;  // Each group sweep has its own retry budget
+      for (DSDeviceNumber i = 0; i < ThermometersFound; i++) {
+        if (!(GetDeviceGroups(i) & mask)) continue;
+        int16_t temperature = ReadDeviceTemp(i);
+        if (temperature != DS_BAD_TEMPERATURE) _GroupStats[group].add(temperature);
+      }  // of for-next each member
+      _SweepRetriesLeft = UINT8_MAX;
+      _GroupConverting &= ~mask;
+      updated |= mask;
+    } else if (_GroupPeriod[group] && (int32_t)(millis() - _GroupDue[group]) >= 0) {
+      DSDeviceNumber members = 0;  // Number of devices in the group
+      for (DSDeviceNumber i = 0; i < ThermometersFound; i++) {
+        if (GetDeviceGroups(i) & mask) members++;
+      }  // of for-next each device
+      if (members == 0) continue;
+      if (Parasitic || members == ThermometersFound) {
+        DeviceStartConvert();  // One command for all devices
+      } else {
+        for (DSDeviceNumber i = 0; i < ThermometersFound; i++) {
+          if (GetDeviceGroups(i) & mask) DeviceStartConvert(i);
+        }  // of for-next each device
+      }    // if-then-else all devices
+      _GroupDue[group] += _GroupPeriod[group];  // Keep the cadence of the schedule
+      if ((int32_t)(millis() - _GroupDue[group]) >= 0) _GroupDue[group] = millis();  // Overrun
+      _GroupConverting |= mask;
+    }  // if-then-else group is due
+  }    // of for-next each group
+  return (updated);
+}  // of method ServiceGroups()
+DSStatistics DSFamily_Class::GetGroupStatistics(const uint8_t group) {
+  /*!
+    @brief      Return the statistics of the last readings of a group taken by ServiceGroups()
+    @param[in]  group Group number, 0 to DS_GROUP_COUNT - 1
+    @return     Minimum, maximum, average and standard deviation of the members, a count of 0 if
+                the group hasn't been read yet
+  */
+  if (group >= DS_GROUP_COUNT) return (DSStatistics());
+  return (_GroupStats[group]);
+}  // of method GetGroupStatistics()
+#endif
+#if DS_SAMPLER_SIZE > 0
+void DSFamily_Class::StartSampler(const uint16_t periodMillis, const bool raw) {
+  /*!
+    @brief      Start or stop the background sampler of all devices
+    @details    The first conversion is started by the next call to ServiceSampler(). Readings
+                already in the ring buffer are kept
+    @param[in]  periodMillis Milliseconds from the start of one conversion to the next, 0 to stop
+    @param[in]  raw (Optional, default "false") Store the readings without the calibration
+  */
+  _SamplerPeriod     = periodMillis;
+  _SamplerRaw        = raw;
+  _SamplerDue        = millis();
+  _SamplerNext       = DS_ALL_DEVICES;
+  _SamplerConverting = false;
+}  // of method StartSampler()
+uint8_t DSFamily_Class::ServiceSampler() {
+  /*!
+    @brief      Sample all devices at the rate set by StartSampler(), call repeatedly from loop()
+    @details    Each call does at most one step on the bus: it starts the conversion of all devices
+                when it is due, or reads the next device of the last conversion into the ring
+                buffer, or returns at once. A call therefore takes at most one scratchpad read with
+                its retries and never waits for a conversion. The conversions are started on a
+                fixed schedule of periodMillis, which is kept up after an overrun, and every reading
+                carries the start time of its conversion. Devices keep the previous reading in the
+                scratchpad until a conversion finishes, so without parasitic devices the next
+                conversion is started while the last readings are still being read, as long as
+                those reads are done before it finishes. Readings of a conversion that couldn't be
+                read in time are counted by SamplesDropped(), as are readings which find the ring
+                buffer full. ServiceSampler() is the only producer of the ring buffer and
+                ReadSample() the only consumer, so the two may be called from different contexts,
+                e.g. loop() and a task or interrupt handler, without any locking
+    @return     Number of readings stored by this call, 0 or 1
+  */
+  DS_PROFILE_CALL(DS_CALL_SAMPLER);
+  if (_SamplerPeriod == 0 || ThermometersFound == 0) return (0);
+  if (_SamplerConverting && poll() != DS_CONVERSION_ACTIVE) {
+    if (_SamplerNext != DS_ALL_DEVICES) {
+      _SamplesDropped += ThermometersFound - _SamplerNext;  // Overwritten before they were read
+    }                                                       // if-then reads still outstanding
+    _SamplerConverting = false;
+    _SamplerTime       = _SamplerStart;  // Time stamp of the readings now being read
+    _SamplerNext       = 0;              // from the first device on
+  }                                      // if-then conversion has finished
+  if (!_SamplerConverting && (int32_t)(millis() - _SamplerDue) >= 0 &&
+      (_SamplerNext == DS_ALL_DEVICES ||
+       (!Parasitic && (uint32_t)(ThermometersFound - _SamplerNext) * DS_SCRATCHPAD_READ_MILLIS <
+                          ConversionMillis))) {
+    _SamplerStart = millis();
+    DeviceStartConvert();  // All devices with one command
+    _SamplerConverting = true;
+    _SamplerDue += _SamplerPeriod;                                       // Keep the cadence
+    if ((int32_t)(millis() - _SamplerDue) >= 0) _SamplerDue = millis();  // Overrun
+    if (_SamplerNext != DS_ALL_DEVICES) return (0);
+  }  // if-then due and the reads left end before the conversion, they go on next call
+  if (_SamplerNext == DS_ALL_DEVICES || _SamplerNext >= ThermometersFound) return (0);
+  uint8_t dsBuffer[9];
+  int16_t temperature = DS_BAD_TEMPERATURE;
+  if (Read1WireScratchpad(_SamplerNext, dsBuffer)) {
+    temperature = ScratchpadTemp(_SamplerNext, dsBuffer, _SamplerRaw);
+  }  // if-then the read was successful
+  PushSample(_SamplerNext, temperature);
+  if (++_SamplerNext >= ThermometersFound) _SamplerNext = DS_ALL_DEVICES;  // All read
+  return (1);
+}  // of method ServiceSampler()
+void DSFamily_Class::PushSample(const DSDeviceNumber deviceNumber, const int16_t temperature) {
+  /*!
+    @brief      Store a reading in the ring buffer of the sampler, or count it as dropped if full
+    @details    The head and tail are free-running 8 bit counters, so their difference is the
+                number of readings stored. The reading is written before the head is advanced,
+                and the head is published with release semantics, so the consumer never sees a
+                partly written reading
+    @param[in]  deviceNumber 1-Wire device number
+    @param[in]  temperature Reading in device units, DS_BAD_TEMPERATURE if the device wasn't read
+  */
+  uint8_t head = _SampleHead;  // Only written here
+  if ((uint8_t)(head - __atomic_load_n(&_SampleTail, __ATOMIC_ACQUIRE)) >= DS_SAMPLER_SIZE) {
+    _SamplesDropped++;
+    return;
+  }  // if-then buffer is full
+  DSSample &sample   = _Samples[head & (DS_SAMPLER_SIZE - 1)];
+  sample.timestamp   = _SamplerTime;
+  sample.device      = deviceNumber;
+  sample.temperature = temperature;
+  __atomic_store_n(&_SampleHead, (uint8_t)(head + 1), __ATOMIC_RELEASE);
+}  // of method PushSample()
+bool DSFamily_Class::ReadSample(DSSample &sample) {
+  /*!
+    @brief      Take the oldest reading from the ring buffer of the sampler
+    @details    This never uses the bus and never blocks, it may be called from another context
+                than ServiceSampler(), see there
+    @param[out] sample Oldest reading, unchanged if there is none
+    @return     "true" if a reading was returned
+  */
+  uint8_t tail = _SampleTail;  // Only written here
+  if (__atomic_load_n(&_SampleHead, __ATOMIC_ACQUIRE) == tail) return (false);
+  sample = _Samples[tail & (DS_SAMPLER_SIZE - 1)];
+  __atomic_store_n(&_SampleTail, (uint8_t)(tail + 1), __ATOMIC_RELEASE);
+  return (true);
+}  // of method ReadSample()
+uint8_t DSFamily_Class::SamplesAvailable() {
+  /*!
+    @brief      Return the number of readings in the ring buffer of the sampler
+    @return     Readings which ReadSample() can take without waiting
+  */
+  return ((uint8_t)(__atomic_load_n(&_SampleHead, __ATOMIC_ACQUIRE) -
+                    __atomic_load_n(&_SampleTail, __ATOMIC_ACQUIRE)));
+}  // of method SamplesAvailable()
+uint16_t DSFamily_Class::SamplesDropped() {
+  /*!
+    @brief      Return the number of readings the sampler has lost
+    @details    A reading is lost when the ring buffer is full, or when the next conversion finished
+                before it was read because ServiceSampler() wasn't called often enough
+    @return     Number of lost readings since the start of the program
+  */
+  return (_SamplesDropped);
+}  // of method SamplesDropped()
+#endif
+#if DS_QUEUE_SIZE > 0
+bool DSFamily_Class::QueueRequest(const uint8_t type, const DSDeviceNumber deviceNumber,
+                                  const int16_t value, const uint8_t priority) {
+  /*!
+    @brief      Add a bus request to the queue, it is run by a later call to ServiceQueue()
+    @details    Requests are merged with those already queued wherever the result is the same: a
+                conversion joins the last queued conversion unless a request for one of its devices
+                was queued after that one, and if the two address different devices then the
+                conversion is widened to all devices, which is sent as a single Skip-ROM command. A
+                read of a device which is already waiting to be read for the same conversion is
+                dropped, and a resolution or alarm setting replaces the queued one of the device. A
+                merged request keeps the more urgent of the two priorities. Requests queued earlier
+                which this one depends on inherit its priority, see ServiceQueue()
+    @param[in]  type DSRequestType of the request
+    @param[in]  deviceNumber 1-Wire device number, DS_ALL_DEVICES for all devices except for reads
+    @param[in]  value (Optional) Resolution in bits, or the alarm limits as TL + TH * 256
+    @param[in]  priority (Optional, default DS_PRIORITY_NORMAL) DSRequestPriority
+    @return     "false" if the request is invalid or the queue is full
+  */
+  DSRequest request = {type, priority, deviceNumber, value};
+  if (type > DS_REQUEST_ALARM || (deviceNumber >= ThermometersFound &&
+                                  (deviceNumber != DS_ALL_DEVICES || type == DS_REQUEST_READ))) {
+    return (false);
+  }  // if-then invalid request
+  uint8_t merged = DS_QUEUE_SIZE;  // Queued request the new one is merged into
+  for (uint8_t i = _RequestCount; i-- > 0;) {
+    DSRequest &queued = _Requests[i];
+    if (queued.type == type &&
+        (queued.device == deviceNumber || type == DS_REQUEST_CONVERT)) {
+      merged = i;  // Last request of this kind
+      break;
+    }  // if-then same kind of request
+  }    // of for-next each queued request from the last
+  for (uint8_t i = merged + 1; merged < DS_QUEUE_SIZE && i < _RequestCount; i++) {
+    if (type == DS_REQUEST_CONVERT ? RequestsConflict(_Requests[i], request)
+                                   : RequestsConflict(_Requests[merged], _Requests[i])) {
+      merged = DS_QUEUE_SIZE;  // A later request needs the two to stay apart
+    }                          // if-then later request sits between the two
+  }                            // of for-next each later request
+  if (merged < DS_QUEUE_SIZE) {
+    DSRequest &queued = _Requests[merged];
+    if (queued.device != deviceNumber) queued.device = DS_ALL_DEVICES;  // Skip-ROM conversion
+    if (type != DS_REQUEST_READ) queued.value = value;                  // Newest setting
+    if (priority < queued.priority) queued.priority = priority;
+  } else {
+    if (_RequestCount >= DS_QUEUE_SIZE) return (false);
+    _Requests[_RequestCount++] = request;
+  }  // if-then-else merged with a queued request
+  InheritPriorities();
+  return (true);
+}  // of method QueueRequest()
+uint8_t DSFamily_Class::ServiceQueue() {
+  /*!
+    @brief      Run the most urgent queued request which is ready, call repeatedly from loop()
+    @details    Each call does at most one request and never waits for a conversion. Of the
+                requests that are ready the one with the lowest priority value is run, the earliest
+                one among equals. A request is not ready while a request queued before it for the
+                same device still has to be run: a read waits for the conversion before it, a
+                conversion for the reads and settings before it. Reads and settings also wait until
+                the conversion of their device has finished, and while parasitic devices convert no
+                request is ready at all. Since the requests a request waits for inherit its
+                priority, an urgent read still overtakes background settings of other devices, but
+                never the conversion it needs. The callback set by SetRequestCallback() is called
+                with the request after it has been run, for reads with the reading in the value
+    @return     Number of requests run by this call, 0 or 1
+  */
+  DS_PROFILE_CALL(DS_CALL_QUEUE);
+  uint8_t next = DS_QUEUE_SIZE;  // Request to run
+  if (_RequestCount == 0 || (Parasitic && poll() == DS_CONVERSION_ACTIVE)) return (0);
+  for (uint8_t i = 0; i < _RequestCount; i++) {
+    if ((next == DS_QUEUE_SIZE || _Requests[i].priority < _Requests[next].priority) &&
+        RequestReady(i)) {
+      next = i;
+    }  // if-then more urgent and ready
+  }    // of for-next each queued request
+  if (next == DS_QUEUE_SIZE) return (0);
+  DSRequest request = _Requests[next];
+  memmove(&_Requests[next], &_Requests[next + 1], (_RequestCount - next - 1) * sizeof(DSRequest));
+  _RequestCount--;
+  switch (request.type) {
+    case DS_REQUEST_CONVERT: DeviceStartConvert(request.device); break;
+    case DS_REQUEST_READ: request.value = ReadDeviceTemp(request.device); break;
+    case DS_REQUEST_RESOLUTION: SetDeviceResolution(request.device, request.value); break;
+    default: SetDeviceAlarm(request.device, (int8_t)request.value, (int8_t)(request.value >> 8));
+  }  // of switch the type of request
+  if (_RequestCallback) _RequestCallback(request);
+  return (1);
+}  // of method ServiceQueue()
+uint8_t DSFamily_Class::RequestsQueued() {
+  /*!
+    @brief      Return the number of requests waiting in the queue
+    @return     Number of queued requests, merged requests count once
+  */
+  return (_RequestCount);
+}  // of method RequestsQueued()
+void DSFamily_Class::SetRequestCallback(DSRequestCallback callback) {
+  /*!
+    @brief      Set the function which ServiceQueue() calls for each request done
+    @param[in]  callback Function to call, nullptr for none
+  */
+  _RequestCallback = callback;
+}  // of method SetRequestCallback()
+bool DSFamily_Class::RequestsConflict(const DSRequest &earlier, const DSRequest &later) {
+  /*!
+    @brief      Check if a request has to wait for one queued before it
+    @details    Requests for different devices never depend on each other. For the same device a
+                read needs the conversion before it and a conversion needs the reads and settings
+                before it to be done first; reads and settings don't depend on each other
+    @param[in]  earlier Request queued first
+    @param[in]  later Request queued after it
+    @return     "true" if later may only run after earlier
+  */
+  if (earlier.device != later.device && earlier.device != DS_ALL_DEVICES &&
+      later.device != DS_ALL_DEVICES) {
+    return (false);
+  }  // if-then different devices
+  return ((earlier.type == DS_REQUEST_CONVERT) != (later.type == DS_REQUEST_CONVERT));
+}  // of method RequestsConflict()
+bool DSFamily_Class::RequestReady(const uint8_t index) {
+  /*!
+    @brief      Check if a queued request can be run now
+    @param[in]  index Position of the request in the queue
+    @return     "true" if no earlier request and no conversion keeps it waiting
+  */
+  const DSRequest &request = _Requests[index];
+  for (uint8_t i = 0; i < index; i++) {
+    if (RequestsConflict(_Requests[i], request)) return (false);
+  }  // of for-next each earlier request
+  if (request.type == DS_REQUEST_CONVERT) return (true);
+  if (request.device == DS_ALL_DEVICES) return (poll() != DS_CONVERSION_ACTIVE);
+  return (!DeviceConverting(request.device));
+}  // of method RequestReady()
+void DSFamily_Class::InheritPriorities() {
+  /*!
+    @brief      Give each queued request the most urgent priority of the requests waiting for it
+    @details    The queue is walked from the last request to the first, so the priority is passed
+                along chains of requests which each wait for the one before
+  */
+  for (uint8_t later = _RequestCount; later-- > 1;) {
+    for (uint8_t i = 0; i < later; i++) {
+      if (_Requests[later].priority < _Requests[i].priority &&
+          RequestsConflict(_Requests[i], _Requests[later])) {
+        _Requests[i].priority = _Requests[later].priority;
+      }  // if-then earlier request is less urgent
+    }    // of for-next each earlier request
+  }      // of for-next each request from the last
+}  // of method InheritPriorities()
+#endif
+int16_t DSFamily_Class::MinTemperature(DSDeviceNumber skipDeviceNumber) {
   /*!
     @brief      reads all current device temperatures and returns the lowest value
-    @details    If the optional skipDeviceNumber is specified then that device number is skipped;
-                this is used when one of the thermometers is out-of-band - i.e. if it is attached to
-                an evaporator plate and reads much lower than the others.
+    @details    The value comes from the statistics of the snapshot, so the bus is only read if no
+                snapshot for the current conversion exists. If the optional skipDeviceNumber is
+                specified then that device number is skipped; this is used when one of the
+                thermometers is out-of-band - i.e. if it is attached to an evaporator plate and
+                reads much lower than the others. Only when the skipped device holds the minimum are
+                the other readings searched again. Devices which couldn't be read are ignored
     @param[in]  skipDeviceNumber Device number to skip, defaults to no skipped device
-    @return Minimum temperature
+    @return Minimum temperature, INT16_MAX if there are no readings
   */
+  DS_PROFILE_CALL(DS_CALL_SNAPSHOT);
   int16_t deviceTemp;
-  int16_t minimumTemp = INT16_MAX;  // Starts at highest possible value
-  for (uint8_t i = 0; i < ThermometersFound; i++) {
-    deviceTemp = ReadDeviceTemp(i);  // retrieve the temperature reading
-    if (i != skipDeviceNumber && deviceTemp < minimumTemp)
-      minimumTemp = deviceTemp;  // set if value is less than minimum and not the skip device
-  }                              // of for-next each thermometer
+  int16_t minimumTemp;
+  if (!SnapshotValid) TakeSnapshot();  // Refresh if needed
+  minimumTemp = _SnapshotStats.minimum;
+  if (skipDeviceNumber < ThermometersFound && SnapshotTemp(skipDeviceNumber) == minimumTemp) {
+    minimumTemp = INT16_MAX;  // Starts at highest possible value
+    for (DSDeviceNumber i = 0; i < ThermometersFound; i++) {
+      deviceTemp = SnapshotTemp(i);  // retrieve the temperature reading
+      if (i != skipDeviceNumber && deviceTemp != DS_BAD_TEMPERATURE && deviceTemp < minimumTemp)
+        minimumTemp = deviceTemp;  // set if value is less than minimum and not the skip device
+    }                              // of for-next each thermometer
+  }                                // if-then the skipped device holds the minimum
   return (minimumTemp);
 }  // of method MinTemperature
-int16_t DSFamily_Class::MaxTemperature(uint8_t skipDeviceNumber) {
+int16_t DSFamily_Class::MaxTemperature(DSDeviceNumber skipDeviceNumber) {
   /*!
     @brief      reads all current device temperatures and returns the highest value
-    @details    If the optional skipDeviceNumber is specified then that device number is skipped;
-                this is used when one of the thermometers is out-of-band - i.e. if it is attached to
-                a heat source plate and reads much higher than the others.
+    @details    The value comes from the statistics of the snapshot, so the bus is only read if no
+                snapshot for the current conversion exists. If the optional skipDeviceNumber is
+                specified then that device number is skipped; this is used when one of the
+                thermometers is out-of-band - i.e. if it is attached to a heat source plate and
+                reads much higher than the others. Only when the skipped device holds the maximum
+                are the other readings searched again. Devices which couldn't be read are ignored
     @param[in]  skipDeviceNumber Device number to skip, defaults to no skipped device
-    @return     Maximum temperature
+    @return     Maximum temperature, INT16_MIN if there are no readings
   */
+  DS_PROFILE_CALL(DS_CALL_SNAPSHOT);
   int16_t deviceTemp;
-  int16_t maximumTemp = INT16_MIN;  // Starts at lowest possible value
-  for (uint8_t i = 0; i < ThermometersFound; i++) {
-    deviceTemp = ReadDeviceTemp(i);  // retrieve the temperature reading
-    if (i != skipDeviceNumber && deviceTemp > maximumTemp) {
-      maximumTemp = deviceTemp;
-    }  // if-then not skipped device and greater than current max
-  }    // of for-next each thermometer
+  int16_t maximumTemp;
+  if (!SnapshotValid) TakeSnapshot();  // Refresh if needed
+  maximumTemp = _SnapshotStats.maximum;
+  if (skipDeviceNumber < ThermometersFound && SnapshotTemp(skipDeviceNumber) == maximumTemp) {
+    maximumTemp = INT16_MIN;  // Starts at lowest possible value
+    for (DSDeviceNumber i = 0; i < ThermometersFound; i++) {
+      deviceTemp = SnapshotTemp(i);  // retrieve the temperature reading
+      if (i != skipDeviceNumber && deviceTemp != DS_BAD_TEMPERATURE && deviceTemp > maximumTemp) {
+        maximumTemp = deviceTemp;
+      }  // if-then not skipped device and greater than current max
+    }    // of for-next each thermometer
+  }      // if-then the skipped device holds the maximum
   return (maximumTemp);
 }  // of method MaxTemperature
-int16_t DSFamily_Class::AvgTemperature(const uint8_t skipDeviceNumber) {
+int16_t DSFamily_Class::AvgTemperature(const DSDeviceNumber skipDeviceNumber) {
   /*!
     @brief      reads all current device temperatures and returns the average value
-    @details    If the optional skipDeviceNumber is specified then that device number is skipped;
-                this is used when one of the thermometers is out-of-band - i.e. if it is attached to
-                a heat source or evaporator plate and reads much lower or higher than the others.
+    @details    The value comes from the statistics of the snapshot, so the bus is only read if no
+                snapshot for the current conversion exists. If the optional skipDeviceNumber is
+                specified then that device number is skipped; this is used when one of the
+                thermometers is out-of-band - i.e. if it is attached to a heat source or evaporator
+                plate and reads much lower or higher than the others. The skipped reading is
+                removed from a copy of the statistics. Devices which couldn't be read are ignored
     @param[in]  skipDeviceNumber Device number to skip, defaults to no skipped device
-    @return     Average temperature
-  */
-  int16_t AverageTemp = 0;
-  for (uint8_t i = 0; i < ThermometersFound; i++) {
-    if (i != skipDeviceNumber) AverageTemp += ReadDeviceTemp(i);  // add temperature to the sum
-  }                                                               // of for-next each thermometer
-  if (skipDeviceNumber == UINT8_MAX) {
-    AverageTemp = AverageTemp / ThermometersFound;  // Divide by number of thermometers
-  } else {
-    AverageTemp =
-        AverageTemp / (ThermometersFound - 1);  // Divide by number of thermometers minus 11
-  }                                             // if-then a device was skipped
-  return (AverageTemp);
+    @return     Average temperature rounded to device units, 0 if there are no readings
+  */
+  DS_PROFILE_CALL(DS_CALL_SNAPSHOT);
+  if (!SnapshotValid) TakeSnapshot();  // Refresh if needed
+  DSStatistics stats   = _SnapshotStats;
+  int16_t      skipped = DS_BAD_TEMPERATURE;  // Reading of the skipped device
+  if (skipDeviceNumber < ThermometersFound) skipped = SnapshotTemp(skipDeviceNumber);
+  if (skipped != DS_BAD_TEMPERATURE) stats.remove(skipped);  // Take out the skipped reading
+  return (stats.average());
 }  // of method AvgTemperature
-void DSFamily_Class::SetDeviceResolution(const uint8_t deviceNumber, uint8_t resolution) {
+void DSFamily_Class::SetDeviceResolution(const DSDeviceNumber deviceNumber, uint8_t resolution,
+                                         const bool persist) {
   /*!
     @brief      set the resolution of the DS devices to 9, 10, 11 or 12 bits
-    @details    Lower resolution results in a faster conversion time. The global ConversionMillis is
-                set on the assumption that all devices are set to the same resolution\n\n
+    @details    Lower resolution results in a faster conversion time. The resolution is remembered
+                for each of the first DS_MAX_TRACKED_DEVICES devices so that reads only wait as long
+                as that device needs; ConversionMillis is set to the slowest conversion time of all
+                devices. Devices which already use the resolution aren't written to, so repeated
+                calls cost neither NV write cycles nor time. If deviceNumber is not specified then
+                all devices are set; the changed scratchpads are then copied to NV memory with a
+                single broadcast COPY SCRATCHPAD, so the whole bus takes one NV cycle, unless other
+                1-Wire devices share the bus and each device is copied on its own. With persist
+                set to "false" the copy is left out, so the change costs no NV write cycle and no
+                DS_MAX_NV_CYCLE_TIME (100ms) wait but is lost at the next power-up, or stored by a
+                later broadcast copy. Resolutions lowered by SetAdaptiveResolution() are kept out of
+                every copy, and setting the resolution of such a device makes it its own one.
+                The DS18S20 has a fixed resolution and is left unchanged\n\n
                    Value Resolution Conversion\n
                    ===== ========== ==========\n
                        9  0.5°C      93.75ms\n
                       10  0.25°C    187.5 ms\n
                       11  0.125°C   375   ms\n
                       12  0.0625°C  750   ms
-   @param[in] deviceNumber 1-Wire device number
+   @param[in] deviceNumber 1-Wire device number, DS_ALL_DEVICES for all devices
    @param[in] resolution Device resolution in bits: 9, 10, 11 or 12
+   @param[in] persist (Optional, default "true") Store the resolution in the NV memory
  */
-  uint8_t dsBuffer[9];
-  _LastCommandWasConvert = false;                          // Set switch to false
-  if (resolution < 9 || resolution > 12) resolution = 12;  // Default to full resolution
-  switch (resolution) {
-    case 12: ConversionMillis = DS_12b_CONVERSION_TIME; break;
-    case 11: ConversionMillis = DS_11b_CONVERSION_TIME; break;
-    case 10: ConversionMillis = DS_10b_CONVERSION_TIME; break;
-    case 9: ConversionMillis = DS_9b_CONVERSION_TIME; break;
-    default: ConversionMillis = DS_12b_CONVERSION_TIME;
-  }                                             // of switch statement for precision
-  resolution = (resolution - 9) << 5;           // Shift resolution bits over
-  Read1WireScratchpad(deviceNumber, dsBuffer);  // Read device scratchpad
-  SelectDevice(deviceNumber);                   // Reset 1-wire, address device
-  write_byte(DS_WRITE_SCRATCHPAD);              // Write scratchpad, send 3 bytes
-  write_byte(dsBuffer[DS_USER_BYTE_1]);         // Restore the old user byte 1
-  write_byte(dsBuffer[DS_USER_BYTE_2]);         // Restore the old user byte 2
-  write_byte(resolution);                       // Set configuration register
-  write_byte(DS_COPY_SCRATCHPAD);               // Copy scratchpad to NV memory
-  delay(DS_MAX_NV_CYCLE_TIME);                  // Give the DS18x20 time to process
+  DS_PROFILE_CALL(DS_CALL_RESOLUTION);
+  if (deviceNumber != DS_ALL_DEVICES) {
+    WriteResolutions(deviceNumber, deviceNumber, 0, resolution, persist);
+  } else if (ThermometersFound > 0) {
+    WriteResolutions(0, ThermometersFound - 1, 0, resolution, persist);
+  }  // if-then-else one device or all devices
 }  // of method SetDeviceResolution
-uint8_t DSFamily_Class::GetDeviceResolution(const uint8_t deviceNumber) {
+void DSFamily_Class::WriteResolutions(const DSDeviceNumber first, const DSDeviceNumber last,
+                                      const uint8_t groups, uint8_t resolution,
+                                      const bool persist) {
+  /*!
+    @brief      Set the resolution of a range of devices, see SetDeviceResolution()
+    @details    The changed scratchpads are only copied with one broadcast COPY SCRATCHPAD when the
+                range holds all devices, no groups are given and the bus has no other devices, see
+                CopyScratchpad(). Otherwise each changed device is copied on its own, since the
+                broadcast would reach all others
+    @param[in]  first First device number to set
+    @param[in]  last Last device number to set
+    @param[in]  groups Only set the devices in one of these groups, 0 to set all of them
+    @param[in]  resolution Device resolution in bits: 9, 10, 11 or 12
+    @param[in]  persist Copy the changed scratchpads to the NV memory
+  */
+  uint8_t        dsBuffer[9];
+  DSDeviceNumber changed   = first;  // Last device whose scratchpad was written
+  DSDeviceNumber written   = 0;      // Number of scratchpads written
+  bool           broadcast = groups == 0 && first == 0 && last == ThermometersFound - 1 &&
+                           !_OtherDevices;
+  _LastCommandWasConvert   = false;                        // Set switch to false
+  if (resolution < 9 || resolution > 12) resolution = 12;  // Default to full resolution
+  for (DSDeviceNumber i = first;; i++) {
+    if ((groups == 0 || (GetDeviceGroups(i) & groups)) && Read1WireScratchpad(i, dsBuffer)) {
+      if (ROM_NO[0] == DS18S20_FAMILY) {
+        SetTrackedResolution(i, 12);  // Fixed 750ms conversion
+      } else {
+        SetTrackedResolution(i, resolution);  // Remember the resolution
+#if DS_ADAPTIVE_RESOLUTION > 0
+        if (i < DS_ADAPTIVE_RESOLUTION) _AdaptiveStored[i] = 0;  // Now the device's own one
+#endif
+        if (WriteScratchpad(i, dsBuffer, dsBuffer[DS_USER_BYTE_1], dsBuffer[DS_USER_BYTE_2],
+                            (dsBuffer[DS_CONFIG_BYTE] & ~0x60) | ((resolution - 9) << 5))) {
+          written++;
+          changed = i;                                   // Remember for a single copy
+          if (persist && !broadcast) CopyScratchpad(i);  // Others keep their NV memory
+        }                                                // if-then scratchpad changed
+      }                                                  // if-then-else a DS18S20
+    }                                                    // if-then device could be read
+    if (i == last) break;
+  }  // for-next each device
+  ConversionMillis = DS_CONVERSION_TIME[TrackedResolution(last) - 9];
+  for (DSDeviceNumber i = 0; i < ThermometersFound; i++) {
+    ConversionMillis = max(ConversionMillis, DS_CONVERSION_TIME[TrackedResolution(i) - 9]);
+  }  // for-next each device to find the slowest
+  if (written && persist && broadcast) {
+    CopyScratchpad(written == 1 ? changed : DS_ALL_DEVICES);  // One NV write cycle for all
+  }  // if-then store the whole bus at once
+}  // of method WriteResolutions()
+uint8_t DSFamily_Class::GetDeviceResolution(const DSDeviceNumber deviceNumber) {
   /*!
     @brief      Get the device resolution
     @param[in]  deviceNumber 1-Wire device number
     @return number of bits resolution (9, 10, 11 or 12)
   */
+  DS_PROFILE_CALL(DS_CALL_RESOLUTION);
   uint8_t resolution, dsBuffer[9];
-  _LastCommandWasConvert = false;                    // Set switch to false
-  Read1WireScratchpad(deviceNumber, dsBuffer);       // Read from the device scratchpad
-  resolution = (dsBuffer[DS_CONFIG_BYTE] >> 5) + 9;  // get bits 6&7 from the config byte
+  _LastCommandWasConvert = false;                          // Set switch to false
+  Read1WireScratchpad(deviceNumber, dsBuffer);             // Read from the device scratchpad
+  resolution = ((dsBuffer[DS_CONFIG_BYTE] >> 5) & 3) + 9;  // get bits 6&7 from the config byte
+  if (ROM_NO[0] == DS18S20_FAMILY) resolution = 12;        // which the DS18S20 doesn't have
+  SetTrackedResolution(deviceNumber, resolution);          // Keep tracked value in sync
   return (resolution);
 }  // of method GetDeviceResolution()
-float DSFamily_Class::StdDevTemperature(const uint8_t skipDeviceNumber) {
+#if DS_ADAPTIVE_RESOLUTION > 0
+void DSFamily_Class::SetAdaptiveResolution(const uint16_t fastRate, const uint16_t calmRate,
+                                           const uint8_t fastResolution,
+                                           const uint8_t calmSweeps) {
+  /*!
+    @brief      Let the resolution of the first DS_ADAPTIVE_RESOLUTION devices follow their readings
+    @details    The rate of change of a device is taken from its readings in two snapshots, over
+                the time between the starts of their conversions, and a change of one unit of the
+                current resolution is ignored as noise. A device whose rate reaches fastRate is set
+                to fastResolution, and it returns to its own resolution once calmSweeps snapshots in
+                a row have seen a rate of at most calmRate, rates in between keep the current one.
+                Devices whose own resolution is at most fastResolution aren't changed. The lowered
+                resolution never reaches the NV memory, see CopyScratchpad(). Only devices which
+                fit into the snapshot buffer are adapted
+    @param[in]  fastRate Rate in 1/16°C per minute which lowers the resolution, 0 to stop adapting
+    @param[in]  calmRate Highest rate in 1/16°C per minute which counts as calm, below fastRate
+    @param[in]  fastResolution (Optional, default 10) Resolution while changing fast, 9 to 11
+    @param[in]  calmSweeps (Optional, default 3) Calm snapshots before restoring the resolution
+  */
+  _AdaptiveFast  = fastRate;
+  _AdaptiveSlow  = calmRate;
+  _AdaptiveBits  = fastResolution < 9 ? 9 : (fastResolution > 11 ? 11 : fastResolution);
+  _AdaptiveCount = calmSweeps;
+  _AdaptiveTime  = _ConvStartTime;  // The next sweep only sets the starting point
+  memset(_AdaptiveCalm, 0, sizeof(_AdaptiveCalm));
+}  // of method SetAdaptiveResolution()
+void DSFamily_Class::AdaptResolution(const DSDeviceNumber deviceNumber, const int16_t temperature,
+                                     const uint32_t elapsed) {
+  /*!
+    @brief      Change the resolution of a device according to its rate of change
+    @details    Called by TakeSnapshot() with the new reading while the snapshot still holds the
+                previous one, see SetAdaptiveResolution()
+    @param[in]  deviceNumber 1-Wire device number
+    @param[in]  temperature New reading in device units, DS_BAD_TEMPERATURE if not read
+    @param[in]  elapsed Milliseconds between the starts of the two conversions
+  */
+  if (_AdaptiveFast == 0 || deviceNumber >= DS_ADAPTIVE_RESOLUTION ||
+      deviceNumber >= _SnapshotSize || temperature == DS_BAD_TEMPERATURE ||
+      _Snapshot[deviceNumber] == DS_BAD_TEMPERATURE || ROM_NO[0] == DS18S20_FAMILY) {
+    return;
+  }  // if-then device isn't adapted or there are no two readings
+  uint8_t resolution = TrackedResolution(deviceNumber);
+  int32_t change     = (int32_t)temperature - _Snapshot[deviceNumber];
+  if (change < 0) change = -change;
+  change -= 1 << (12 - resolution);  // One step of the resolution is noise
+  uint32_t rate = change > 0 ? (uint32_t)change * 60000 / elapsed : 0;  // 1/16°C per minute
+  uint8_t stored = _AdaptiveStored[deviceNumber];  // Own resolution, 0 if not lowered
+  if (rate >= _AdaptiveFast) {
+    _AdaptiveCalm[deviceNumber] = 0;
+    if (resolution > _AdaptiveBits || (stored && resolution != _AdaptiveBits)) {
+      SetDeviceResolution(deviceNumber, _AdaptiveBits, false);  // Clears the own resolution,
+      _AdaptiveStored[deviceNumber] = stored ? stored : resolution;  // so remember it afterwards
+    }  // if-then resolution is to be lowered
+  } else if (rate > _AdaptiveSlow) {
+    _AdaptiveCalm[deviceNumber] = 0;  // Neither fast nor calm
+  } else if (stored && ++_AdaptiveCalm[deviceNumber] >= _AdaptiveCount) {
+    _AdaptiveCalm[deviceNumber] = 0;
+    SetDeviceResolution(deviceNumber, stored, false);  // Back to the own resolution
+  }  // if-then-else fast, in between or calm
+}  // of method AdaptResolution()
+void DSFamily_Class::WriteAdaptedResolutions(const DSDeviceNumber deviceNumber,
+                                             const bool           adapted) {
+  /*!
+    @brief      Write the lowered or the own resolution to the scratchpads of lowered devices
+    @details    Called around each COPY SCRATCHPAD, which stores whatever the scratchpad holds. Only
+                devices whose resolution SetAdaptiveResolution() has lowered are written to
+    @param[in]  deviceNumber 1-Wire device number, DS_ALL_DEVICES for all devices
+    @param[in]  adapted "true" to write the lowered resolution, "false" for the own one
+  */
+  uint8_t dsBuffer[9];
+  for (DSDeviceNumber i = 0; i < DS_ADAPTIVE_RESOLUTION && i < ThermometersFound; i++) {
+    if (_AdaptiveStored[i] && (deviceNumber == DS_ALL_DEVICES || deviceNumber == i) &&
+        Read1WireScratchpad(i, dsBuffer)) {
+      uint8_t resolution = adapted ? TrackedResolution(i) : _AdaptiveStored[i];
+      WriteScratchpad(i, dsBuffer, dsBuffer[DS_USER_BYTE_1], dsBuffer[DS_USER_BYTE_2],
+                      (dsBuffer[DS_CONFIG_BYTE] & ~0x60) | ((resolution - 9) << 5));
+    }  // if-then device is lowered and could be read
+  }    // for-next each adapted device
+}  // of method WriteAdaptedResolutions()
+#endif
+float DSFamily_Class::StdDevTemperature(const DSDeviceNumber skipDeviceNumber) {
   /*!
     @brief      reads all current device temperatures and returns the standard deviation
-    @details    If the optional skipDeviceNumber is specified then that device number is skipped;
-                this is used when one of the thermometers is out-of-band and should be ignored
+    @details    The value comes from the statistics of the snapshot, so the bus is only read if no
+                snapshot for the current conversion exists. If the optional skipDeviceNumber is
+                specified then that device number is skipped; this is used when one of the
+                thermometers is out-of-band and should be ignored. The population standard
+                deviation is computed with integers in 1/16 device units, only the result is
+                converted to floating point
     @param[in]  skipDeviceNumber Device number to skip, defaults to no skipped device
     @return Floating point standard deviation
   */
-  float   StdDev      = 0;
-  int16_t AverageTemp = AvgTemperature(skipDeviceNumber);  // Compute the average
-  for (uint8_t i = 0; i < ThermometersFound; i++) {
-    if (i != skipDeviceNumber)
-      StdDev += sq(AverageTemp - ReadDeviceTemp(i));  // add squared variance delta to sum
-  }                                                   // of for-next each thermometer
-  if (skipDeviceNumber == UINT8_MAX) {
-    StdDev = StdDev / ThermometersFound;
-  } else {
-    StdDev = StdDev / (ThermometersFound - 1);
-  }
-  StdDev = sqrt(StdDev);  // compute the square root
-  return (StdDev);
+  DS_PROFILE_CALL(DS_CALL_SNAPSHOT);
+  if (!SnapshotValid) TakeSnapshot();  // Refresh if needed
+  DSStatistics stats   = _SnapshotStats;
+  int16_t      skipped = DS_BAD_TEMPERATURE;  // Reading of the skipped device
+  if (skipDeviceNumber < ThermometersFound) skipped = SnapshotTemp(skipDeviceNumber);
+  if (skipped != DS_BAD_TEMPERATURE) stats.remove(skipped);  // Take out the skipped reading
+  return (stats.stdDev16() / 16.0);
 }  // of method StdDevTemperature
+int16_t DSFamily_Class::MedianTemperature() {
+  /*!
+    @brief      Return the median of the current device temperatures
+    @details    The readings of the snapshot are copied to the stack and only ordered as far as
+                needed to find the middle value, which takes linear time. With an even number of
+                readings the average of the two middle values is returned. Devices which couldn't
+                be read are ignored
+    @return     Median temperature in device units, DS_BAD_TEMPERATURE if there are no readings
+  */
+  DS_PROFILE_CALL(DS_CALL_SNAPSHOT);
+  int16_t        values[DS_ROBUST_SIZE];          // Readings to be ordered
+  DSDeviceNumber count = RobustReadings(values);  // Number of good readings
+  if (count == 0) return (DS_BAD_TEMPERATURE);
+  return (MedianOf(values, count));
+}  // of method MedianTemperature()
+int16_t DSFamily_Class::TrimmedMeanTemperature(const uint8_t trimPercent) {
+  /*!
+    @brief      Return the mean of the current device temperatures without the extremes
+    @details    The given percentage of the readings is dropped from both the low and the high end
+                before the rest is averaged, at least one reading is always kept. The readings of
+                the snapshot are split with two in-place selections instead of being sorted.
+                Devices which couldn't be read are ignored
+    @param[in]  trimPercent Percentage of the readings dropped at each end, defaults to 20
+    @return     Trimmed mean in device units, DS_BAD_TEMPERATURE if there are no readings
+  */
+  DS_PROFILE_CALL(DS_CALL_SNAPSHOT);
+  int16_t        values[DS_ROBUST_SIZE];                       // Readings to be ordered
+  DSDeviceNumber count = RobustReadings(values);               // Number of good readings
+  DSDeviceNumber trim  = (uint32_t)count * trimPercent / 100;  // Readings dropped at each end
+  int32_t        sum   = 0;                                    // Sum of the kept readings
+  if (count == 0) return (DS_BAD_TEMPERATURE);
+  if (2 * trim >= count) trim = (count - 1) / 2;  // Keep at least one reading
+  DSDeviceNumber kept = count - 2 * trim;         // Readings being averaged
+  if (trim > 0) {
+    SelectNth(values, count, trim);                // Lowest readings to the front
+    SelectNth(values + trim, count - trim, kept);  // and highest ones to the end
+  }                                                // if-then readings are dropped
+  for (DSDeviceNumber i = trim; i < trim + kept; i++) sum += values[i];
+  return ((sum >= 0 ? sum + kept / 2 : sum - kept / 2) / kept);
+}  // of method TrimmedMeanTemperature()
+int16_t DSFamily_Class::RobustTemperature(const uint8_t madLimit) {
+  /*!
+    @brief      Return the mean of the current device temperatures without the outliers
+    @details    Readings which are further from the median than madLimit times the median absolute
+                deviation (MAD, scaled by 1.4826 to match a standard deviation) are dropped and the
+                rest is averaged, so failing sensors and those on an evaporator or heat source plate
+                are left out automatically. The MAD is at least one device unit, so a bus where all
+                devices agree doesn't drop readings which are off by the last bit. Devices which
+                couldn't be read are always dropped. DeviceExcluded() reports which devices were
+                left out by the last call
+    @param[in]  madLimit Distance from the median in scaled MADs beyond which readings are dropped
+    @return     Mean of the remaining readings in device units, DS_BAD_TEMPERATURE if none remain
+  */
+  DS_PROFILE_CALL(DS_CALL_SNAPSHOT);
+  int16_t        values[DS_ROBUST_SIZE];                        // Readings to be ordered
+  DSDeviceNumber count = RobustReadings(values);                // Number of good readings
+  DSDeviceNumber kept  = 0;                                     // Readings being averaged
+  int32_t        sum   = 0;                                     // Sum of the kept readings
+  memset(_DeviceExcluded, UINT8_MAX, sizeof(_DeviceExcluded));  // Nothing kept yet
+  if (count == 0) return (DS_BAD_TEMPERATURE);
+  int16_t median = MedianOf(values, count);
+  for (DSDeviceNumber i = 0; i < count; i++) values[i] = abs(values[i] - median);  // Deviations
+  int16_t  mad   = MedianOf(values, count);
+  uint32_t limit = ((uint32_t)(mad > 0 ? mad : 1) * madLimit * 1483 + 500) / 1000;
+  for (DSDeviceNumber i = 0; i < RobustDevices(); i++) {
+    int16_t temperature = _Snapshot[i];
+    if (temperature == DS_BAD_TEMPERATURE || (uint32_t)abs(temperature - median) > limit) continue;
+    _DeviceExcluded[i >> 3] &= ~(1 << (i & 7));  // Reading is used
+    sum += temperature;
+    kept++;
+  }  // of for-next each device
+  if (kept == 0) return (DS_BAD_TEMPERATURE);
+  return ((sum >= 0 ? sum + kept / 2 : sum - kept / 2) / kept);
+}  // of method RobustTemperature()
+bool DSFamily_Class::DeviceExcluded(const DSDeviceNumber deviceNumber) {
+  /*!
+    @brief      Check if a device was left out by the last call to RobustTemperature()
+    @param[in]  deviceNumber 1-Wire device number
+    @return     "true" if the reading was dropped as an outlier or bad, or the device wasn't part of
+                the readings because it is beyond DS_ROBUST_SIZE or the snapshot buffer
+  */
+  if (deviceNumber >= DS_ROBUST_SIZE) return (true);
+  return (_DeviceExcluded[deviceNumber >> 3] & (1 << (deviceNumber & 7)));
+}  // of method DeviceExcluded()
+DSDeviceNumber DSFamily_Class::RobustDevices() {
+  /*!
+    @brief      Return the number of devices considered by the median and outlier functions
+    @details    Only readings held in the snapshot buffer are used, so that the functions never
+                read the bus beyond the snapshot
+    @return     Number of devices, at most DS_ROBUST_SIZE
+  */
+  DSDeviceNumber devices = ThermometersFound;
+  if (devices > _SnapshotSize) devices = _SnapshotSize;
+  if (devices > DS_ROBUST_SIZE) devices = DS_ROBUST_SIZE;
+  return (devices);
+}  // of method RobustDevices()
+DSDeviceNumber DSFamily_Class::RobustReadings(int16_t values[DS_ROBUST_SIZE]) {
+  /*!
+    @brief      Copy the good readings of the snapshot into a buffer, taking a snapshot if needed
+    @param[out] values Buffer for the readings
+    @return     Number of readings copied
+  */
+  DSDeviceNumber count = 0;
+  if (!SnapshotValid) TakeSnapshot();  // Refresh if needed
+  for (DSDeviceNumber i = 0; i < RobustDevices(); i++) {
+    if (_Snapshot[i] != DS_BAD_TEMPERATURE) values[count++] = _Snapshot[i];
+  }  // of for-next each device
+  return (count);
+}  // of method RobustReadings()
+int16_t DSFamily_Class::SelectNth(int16_t values[], const DSDeviceNumber count,
+                                  const DSDeviceNumber n) {
+  /*!
+    @brief      Find the n-th smallest value by partially ordering the buffer in place
+    @details    Hoare's selection algorithm as given by N. Wirth: the buffer is partitioned around
+                the value at position n until that position holds the value it would have in a
+                sorted buffer. All values before it are then less or equal and all after it greater
+                or equal. Takes linear time on average and needs no extra memory
+    @param[in,out] values Buffer, reordered by the call
+    @param[in]  count Number of values in the buffer
+    @param[in]  n Position being selected, 0 for the smallest value
+    @return     The n-th smallest value
+  */
+  int16_t left  = 0;          // Range still containing position n
+  int16_t right = count - 1;  // Inclusive end of the range
+  while (left < right) {
+    int16_t pivot = values[n];  // Partition around the current value at n
+    int16_t i     = left;
+    int16_t j     = right;
+    do {
+      while (values[i] < pivot) i++;
+      while (pivot < values[j]) j--;
+      if (i <= j) {
+        int16_t swap = values[i];
+        values[i++]  = values[j];
+        values[j--]  = swap;
+      }  // if-then swap the pair
+    } while (i <= j);
+    if (j < n) left = i;   // Position n is in the upper part
+    if (n < i) right = j;  // or in the lower part
+  }                        // of while range is not empty
+  return (values[n]);
+}  // of method SelectNth()
+int16_t DSFamily_Class::MedianOf(int16_t values[], const DSDeviceNumber count) {
+  /*!
+    @brief      Return the median of a buffer, which is reordered in the process
+    @param[in,out] values Buffer of at least one value
+    @param[in]  count Number of values in the buffer
+    @return     Middle value, or the average of the two middle values for an even count
+  */
+  int16_t upper = SelectNth(values, count, count / 2);  // Values before it are all lower
+  if (count & 1) return (upper);
+  int16_t lower = values[0];  // Largest of the lower half
+  for (DSDeviceNumber i = 1; i < count / 2; i++) {
+    if (values[i] > lower) lower = values[i];
+  }  // of for-next each lower value
+  return (((int32_t)lower + upper) / 2);
+}  // of method MedianOf()
+DSDeviceNumber DSFamily_Class::TakeSnapshot() {
+  /*!
+    @brief      Read every device once and store the readings in the snapshot buffer
+    @details    The calibrated temperature of each device is read from the bus a single time and
+                stored together with the time of the sweep. Each reading is added to the statistics
+                of the snapshot as it arrives, and the aggregate functions MinTemperature(),
+                MaxTemperature(), AvgTemperature() and StdDevTemperature() return those, so
+                computing all of them only costs one sweep of the bus. The snapshot remains valid
+                until the next conversion is started or a calibration is changed. Devices which
+                can't be read are stored as DS_BAD_TEMPERATURE and left out of the statistics. If
+                more devices are present than fit into the snapshot buffer then those are still
+                part of the statistics, but are read from the bus again when requested. Reads
+                with a bad CRC are repeated within the sweep budget set by SetRetryBudget(). The
+                resolution of adaptive devices is changed here, see SetAdaptiveResolution()
+    @return     Number of devices successfully read
+  */
+  DS_PROFILE_CALL(DS_CALL_SNAPSHOT);
+  DSDeviceNumber goodReadings = 0;
+  _SnapshotStats.clear();            // Start the statistics over
+  _SweepRetriesLeft = _SweepRetries;  // and the retry budget of the sweep
+#if DS_ADAPTIVE_RESOLUTION > 0
+  uint32_t elapsed = _ConvStartTime - _AdaptiveTime;  // Between the conversions of two sweeps
+  _AdaptiveTime    = _ConvStartTime;
+#endif
+  for (DSDeviceNumber i = 0; i < ThermometersFound; i++) {
+    int16_t temperature = ReadDeviceTemp(i);
+#if DS_ADAPTIVE_RESOLUTION > 0
+    if (elapsed) AdaptResolution(i, temperature, elapsed);  // Before the old reading is replaced
+#endif
+    if (SnapshotReading(i, temperature)) goodReadings++;  // Count the good readings
+  }                                                       // of for-next each device
+  _SweepRetriesLeft = UINT8_MAX;                                // Single reads aren't limited
+  SnapshotMillis = millis();                                    // Store the time of the sweep
+  SnapshotValid  = true;                                        // Readings are current
+  return (goodReadings);
+}  // of method TakeSnapshot()
+bool DSFamily_Class::SnapshotReading(const DSDeviceNumber deviceNumber, const int16_t temperature) {
+  /*!
+    @brief      Store a reading in the snapshot buffer and add it to the statistics
+    @param[in]  deviceNumber 1-Wire device number
+    @param[in]  temperature Calibrated reading, DS_BAD_TEMPERATURE if the device couldn't be read
+    @return     "true" for a good reading
+  */
+  if (deviceNumber < _SnapshotSize) _Snapshot[deviceNumber] = temperature;
+  if (temperature == DS_BAD_TEMPERATURE) return (false);
+  _SnapshotStats.add(temperature);  // Statistics across the devices
+#if DS_DEVICE_STATISTICS > 0
+  if (deviceNumber < DS_DEVICE_STATISTICS) _DeviceStats[deviceNumber].add(temperature);
+#endif
+  return (true);
+}  // of method SnapshotReading()
+int16_t DSFamily_Class::SnapshotTemp(const DSDeviceNumber deviceNumber) {
+  /*!
+    @brief      Return the temperature of a device from the snapshot
+    @details    If the snapshot is no longer valid then a new one is taken first. Devices which
+                don't fit into the snapshot buffer are read directly from the bus
+    @param[in]  deviceNumber 1-Wire device number
+    @return     Temperature reading in device units
+  */
+  DS_PROFILE_CALL(DS_CALL_SNAPSHOT);
+  if (!SnapshotValid) TakeSnapshot();  // Refresh if needed
+  if (deviceNumber < ThermometersFound && deviceNumber < _SnapshotSize) {
+    return (_Snapshot[deviceNumber]);     // Return stored value
+  }                                       // if-then device is in the snapshot
+  return (ReadDeviceTemp(deviceNumber));  // Otherwise read the device
+}  // of method SnapshotTemp()
+void DSFamily_Class::SetSnapshotBuffer(int16_t *buffer, const DSDeviceNumber bufferSize) {
+  /*!
+    @brief      Use a caller-supplied buffer for the snapshot
+    @details    The internal buffer holds DS_SNAPSHOT_SIZE readings, when more devices are attached
+                then a larger buffer can be supplied here so that all devices are part of a sweep.
+                Passing a nullptr reverts to the internal buffer. The current snapshot is discarded
+    @param[in]  buffer Array of at least bufferSize int16_t values, or nullptr
+    @param[in]  bufferSize Number of entries in buffer
+  */
+  if (buffer == nullptr) {
+    _Snapshot     = _SnapshotBuffer;   // Revert to the internal buffer
+    _SnapshotSize = DS_SNAPSHOT_SIZE;  // and its size
+  } else {
+    _Snapshot     = buffer;      // Use the caller's buffer
+    _SnapshotSize = bufferSize;  // and size
+  }                              // if-then-else internal buffer
+  SnapshotValid = false;         // Contents are not valid anymore
+}  // of method SetSnapshotBuffer()
+#if DS_DEVICE_STATISTICS > 0
+DSStatistics DSFamily_Class::GetDeviceStatistics(const DSDeviceNumber deviceNumber) {
+  /*!
+    @brief      Return the running statistics of a device over time
+    @details    Every snapshot adds one sample for each of the first DS_DEVICE_STATISTICS devices,
+                so the statistics cover all conversions since the last ResetStatistics()
+    @param[in]  deviceNumber 1-Wire device number
+    @return     Statistics of the device, with a count of 0 for devices which aren't tracked
+  */
+  if (deviceNumber >= DS_DEVICE_STATISTICS) return (DSStatistics());
+  return (_DeviceStats[deviceNumber]);
+}  // of method GetDeviceStatistics()
+void DSFamily_Class::ResetStatistics() {
+  /*!
+    @brief      Clear the running statistics of all devices, this is also done by ScanForDevices()
+  */
+  for (uint16_t i = 0; i < DS_DEVICE_STATISTICS; i++) _DeviceStats[i].clear();
+}  // of method ResetStatistics()
+#endif
 void DSFamily_Class::reset_search() {
   /*!
     @brief      Reset the 1-Wire search
@@ -534,15 +2511,20 @@ void DSFamily_Class::write_byte(uint8_t v, uint8_t power) {
   */
   uint8_t bitMask;
   for (bitMask = 0x01; bitMask; bitMask <<= 1) {
-    write_bit((bitMask & v) ? 1 : 0);  // Write bits until empty
-  }                                    // for-next each bit
-  if (!power) {
-    noInterrupts();
-    DIRECT_MODE_INPUT(baseReg, bitmask);
-    DIRECT_WRITE_LOW(baseReg, bitmask);
-    interrupts();
-  }  // of if-then we have parasite mode
+    bus_write_bit((bitMask & v) ? 1 : 0);  // Write bits until empty
+  }                                        // for-next each bit
+  if (!power) depower();  // Let the pin float after the write
 }  // of method write_byte()
+void DSFamily_Class::depower(void) {
+  /*!
+    @brief      Stop driving the 1-Wire line
+    @details    The pin goes tri-state so that the pull-up resistor holds the line high
+  */
+  noInterrupts();
+  DIRECT_MODE_INPUT(baseReg, bitmask);
+  DIRECT_WRITE_LOW(baseReg, bitmask);
+  interrupts();
+}  // of method depower()
 uint8_t DSFamily_Class::read_byte() {
   /*!
     @brief      Read a byte from 1-wire
@@ -551,8 +2533,8 @@ uint8_t DSFamily_Class::read_byte() {
   uint8_t bitMask;
   uint8_t r = 0;
   for (bitMask = 0x01; bitMask; bitMask <<= 1) {
-    if (read_bit()) r |= bitMask;  // For each bit in the byte read bit into correct position
-  }                                // of for-next each bit in the byte
+    if (bus_read_bit()) r |= bitMask;  // For each bit in the byte read bit into correct position
+  }                                    // of for-next each bit in the byte
   return r;
 }  // of method read_byte()
 void DSFamily_Class::select(const uint8_t rom[8]) {
@@ -565,15 +2547,39 @@ void DSFamily_Class::select(const uint8_t rom[8]) {
     write_byte(rom[i]);  // Send the ROM address bytes
   }                      // for-next each byte in ROM buffer
 }  // of method select()
-uint8_t DSFamily_Class::search(uint8_t *newAddr) {
+bool DSFamily_Class::verify(const uint8_t rom[8]) {
+  /*!
+    @brief      Check the presence of one device with a single pass of the search algorithm
+    @details    At each bit of the address the devices still taking part send the bit and its
+                complement, and then only those whose bit matches the one written stay in. The bit
+                of the given address is always written, so the device is present if at every bit
+                at least one remaining device has the same bit. The pass is abandoned at the first
+                bit where none has
+    @param[in]  rom  8-Byte ROM address to check
+    @return     "true" if a device with that address answered
+  */
+  if (!bus_reset()) return (false);  // No presence pulse at all
+  write_byte(DS_SEARCH);
+  for (uint8_t i = 0; i < 64; i++) {
+    const uint8_t bit        = (rom[i >> 3] >> (i & 7)) & 1;
+    const uint8_t id_bit     = bus_read_bit();  // 0 if any device has a 0
+    const uint8_t cmp_id_bit = bus_read_bit();  // 0 if any device has a 1
+    if (bit ? cmp_id_bit : id_bit) return (false);
+    bus_write_bit(bit);
+  }  // for-next each address bit
+  return (true);
+}  // of method verify()
+uint8_t DSFamily_Class::search(uint8_t *newAddr, const uint8_t command) {
   /*!
     @brief      Search the 1-Wire microLAN using the Dallas Semiconductor search algorithm and code
     @details    Perform a search. If this function returns a '1' then it has enumerated the next
                 device and you may retrieve the ROM from the OneWire::address variable. If there
                 are no devices, no further devices, or something horrible happens in the middle of
                 the enumeration then a 0 is returned.  If a new device is found then its address is
-                copied to newAddr.  Use DSFamily_Class::reset_search() to start over.
+                copied to newAddr.  Use DSFamily_Class::reset_search() to start over. With the
+                ALARM SEARCH command only devices in an alarm state take part in the search
     @param[in]  newAddr  8-Byte ROM Buffer
+    @param[in]  command  DS_SEARCH or DS_ALARM_SEARCH
     @return     TRUE - device found, ROM number in ROM_NO buffer, FALSE - device not found, end of
                 search
   */
@@ -586,17 +2592,17 @@ uint8_t DSFamily_Class::search(uint8_t *newAddr) {
   search_result   = 0;
   if (!LastDeviceFlag)  // if last call was not the last one
   {
-    if (!reset()) {
+    if (!bus_reset()) {
       LastDiscrepancy       = 0;
       LastDeviceFlag        = false;
       LastFamilyDiscrepancy = 0;
       return false;
     }                       // of if-then we have a reset
-    write_byte(DS_SEARCH);  // issue the search command
+    write_byte(command);    // issue the search command
     do                      // loop to do the search
     {
-      id_bit     = read_bit();  // read a bit
-      cmp_id_bit = read_bit();  // and then the complement
+      id_bit     = bus_read_bit();  // read a bit
+      cmp_id_bit = bus_read_bit();  // and then the complement
       if ((id_bit == 1) && (cmp_id_bit == 1))
         break;  // check for no devices on 1-wire
       else {
@@ -623,7 +2629,7 @@ uint8_t DSFamily_Class::search(uint8_t *newAddr) {
         } else {
           ROM_NO[rom_byte_number] &= ~rom_byte_mask;
         }
-        write_bit(search_direction);  // serial number search direction
+        bus_write_bit(search_direction);  // serial number search direction
         id_bit_number++;              // increment the byte counter
         rom_byte_mask <<= 1;          // id_bit_number & shift rom_byte_mask
         if (rom_byte_mask ==
@@ -642,6 +2648,9 @@ uint8_t DSFamily_Class::search(uint8_t *newAddr) {
       if (LastDiscrepancy == 0) LastDeviceFlag = true;  // check for last device
       search_result = true;
     }                                // of if-then search was successful
+#if defined(DS_PROFILE)
+    if (!search_result) DS_PROFILE_COUNT(retries);  // Search pass was interrupted
+#endif
   }                                  // of if-then there are still devices to be found
   if (!search_result || !ROM_NO[0])  // if the search was successful then
   {
@@ -656,24 +2665,101 @@ uint8_t DSFamily_Class::search(uint8_t *newAddr) {
 uint8_t DSFamily_Class::crc8(const uint8_t *addr, uint8_t len) {
   /*!
     @brief      Compute the 8 bit crc of the returned buffer
-    @details    This method uses the iterative method, which is slower than the default 1-Wire
-                table lookup but that uses 255 bytes of scant program memory.
+    @details    Uses the implementation chosen with DS_CRC8_METHOD, see crc8Update()
     @param[in]  addr  Pointer to buffer
     @param[in]  len  Length of buffer
     @return     computed crc8
   */
   uint8_t crc = 0;
-  while (len--) {
-    uint8_t inbyte = *addr++;
-    for (uint8_t i = 8; i; i--) {
-      uint8_t mix = (crc ^ inbyte) & 0x01;
-      crc >>= 1;
-      if (mix) crc ^= 0x8C;
-      inbyte >>= 1;
-    }  // of for-next each byte in the ROM
-  }    // of while data still be to computed
+  while (len--) crc = crc8Update(crc, *addr++);
   return crc;
 }  // of method crc8()
+uint8_t DSFamily_Class::crc8Update(const uint8_t crc, const uint8_t data) {
+  /*!
+    @brief      Fold one byte into a running 1-Wire CRC
+    @details    Scratchpad reads fold in each byte as it arrives, so that the check is done as soon
+                as the last byte has been read; running the CRC over the data and the CRC byte that
+                follows it yields 0. DS_CRC8_METHOD chooses crc8Bitwise(), crc8Nibble() or
+                crc8Table(), which trade program memory for speed
+    @param[in]  crc  CRC of the bytes so far, 0 at the start
+    @param[in]  data Next byte
+    @return     CRC including the byte
+  */
+#if DS_CRC8_METHOD == DS_CRC8_TABLE
+  return (crc8Table(crc, data));
+#elif DS_CRC8_METHOD == DS_CRC8_NIBBLE
+  return (crc8Nibble(crc, data));
+#else
+  return (crc8Bitwise(crc, data));
+#endif
+}  // of method crc8Update()
+uint8_t DSFamily_Class::crc8Bitwise(uint8_t crc, uint8_t data) {
+  /*!
+    @brief      Fold one byte into a running 1-Wire CRC one bit at a time
+    @details    Needs no table, but is the slowest of the three implementations
+    @param[in]  crc  CRC of the bytes so far
+    @param[in]  data Next byte
+    @return     CRC including the byte
+  */
+  for (uint8_t i = 8; i; i--) {
+    uint8_t mix = (crc ^ data) & 0x01;
+    crc >>= 1;
+    if (mix) crc ^= 0x8C;
+    data >>= 1;
+  }  // of for-next each bit
+  return (crc);
+}  // of method crc8Bitwise()
+uint8_t DSFamily_Class::crc8Nibble(uint8_t crc, const uint8_t data) {
+  /*!
+    @brief      Fold one byte into a running 1-Wire CRC 4 bits at a time
+    @details    Uses a 16 byte table in program memory
+    @param[in]  crc  CRC of the bytes so far
+    @param[in]  data Next byte
+    @return     CRC including the byte
+  */
+  crc ^= data;
+  crc = (crc >> 4) ^ pgm_read_byte(&DS_CRC8_NIBBLES[crc & 0x0F]);
+  return ((crc >> 4) ^ pgm_read_byte(&DS_CRC8_NIBBLES[crc & 0x0F]));
+}  // of method crc8Nibble()
+uint8_t DSFamily_Class::crc8Table(const uint8_t crc, const uint8_t data) {
+  /*!
+    @brief      Fold one byte into a running 1-Wire CRC with a single table lookup
+    @details    Uses a 256 byte table in program memory
+    @param[in]  crc  CRC of the bytes so far
+    @param[in]  data Next byte
+    @return     CRC including the byte
+  */
+  return (pgm_read_byte(&DS_CRC8_BYTES[crc ^ data]));
+}  // of method crc8Table()
+#if defined(DS_PROFILE)
+const DSProfileCounters &DSFamily_Class::GetProfile(const uint8_t call) {
+  /*!
+    @brief     Return the profiling counters of a group of public functions
+    @details   Bus activity is charged to the outermost public function that caused it. Counters
+               wrap around silently, call ResetProfile() at the start of each measuring period
+    @param[in] call DSProfileCall group, e.g. DS_CALL_READ_TEMP
+    @return    Counters of the group, DS_CALL_OTHER for an invalid group
+  */
+  if (call >= DS_CALL_COUNT) return (_Profile[DS_CALL_OTHER]);
+  return (_Profile[call]);
+}  // of method GetProfile()
+uint16_t DSFamily_Class::GetDeviceRetries(const DSDeviceNumber deviceNumber) {
+  /*!
+    @brief     Return the number of repeated scratchpad reads of a device due to CRC errors
+    @param[in] deviceNumber 1-Wire device number
+    @return    Retries since the last ResetProfile(), 0 for untracked devices
+  */
+  if (deviceNumber >= DS_MAX_TRACKED_DEVICES) return (0);
+  return (_DeviceRetries[deviceNumber]);
+}  // of method GetDeviceRetries()
+void DSFamily_Class::ResetProfile() {
+  /*!
+    @brief   Clear all profiling counters
+  */
+  memset(_Profile, 0, sizeof(_Profile));
+  memset(_DeviceRetries, 0, sizeof(_DeviceRetries));
+}  // of method ResetProfile()
+#endif
 
 void DSFamily_Class::ParasiticWait() {
   /*!
@@ -682,11 +2768,117 @@ void DSFamily_Class::ParasiticWait() {
                 during conversion. This means that the whole 1-Wire microLAN is effectively blocked
                 during the rather lengthy conversion time; since using the bus would cause the
                 parasitically powered device to abort conversion. Therefore this function will wait
-                until the last conversion request has had enough time to complete. The wait time
-                might be unnecessary, but since we only track the last conversion start rather than
-                track each device independently this is the best we can do.
+                until all active conversions have had enough time to complete.
   */
-  if (Parasitic && ((_ConvStartTime + ConversionMillis) > millis())) {
-    delay((_ConvStartTime + ConversionMillis) - millis());  // then delay until it is finished
-  }  // of if-then we have a parasitic device on the 1-Wire
+  if (Parasitic) WaitForConversion();  // Bus is blocked while parasitic devices convert
 }  // of method ParasiticWait()
+void DSStatistics::clear() {
+  /*!
+    @brief      Remove all samples
+  */
+  count   = 0;
+  minimum = INT16_MAX;
+  maximum = INT16_MIN;
+  _Sum    = 0;
+  _M2     = 0;
+}  // of method clear()
+void DSStatistics::add(const int16_t value) {
+  /*!
+    @brief      Add a sample
+    @details    The sum of squared deviations grows by the product of the deviations of the sample
+                from the old and from the new mean (Welford), which is never negative and below
+                2^28 for all readings of the DS devices. Once the sum reaches 2^31 or the count
+                reaches 2^15 both are halved and the mean is kept, so nothing can overflow
+    @param[in]  value Reading in device units
+  */
+  int32_t sample = (int32_t)value * 16;              // Reading in 1/16 device units
+  int32_t before = count ? mean16() : sample;        // Mean before the sample
+  count++;
+  _Sum += value;
+  _M2 += product16(sample - before, sample - mean16());
+  if (_M2 >= 0x80000000UL || count == 0x8000) {
+    uint16_t half = count >> 1;           // Halve the weight of the old samples
+    _Sum          = mean16() * half / 16;
+    _M2           = _M2 / count * half;
+    count         = half;
+  }  // if-then sums are getting large
+  if (value < minimum) minimum = value;
+  if (value > maximum) maximum = value;
+}  // of method add()
+void DSStatistics::remove(const int16_t value) {
+  /*!
+    @brief      Remove a sample which was added before
+    @details    The mean and variance are restored by reversing add(), the minimum and maximum are
+                not changed
+    @param[in]  value Reading in device units
+  */
+  int32_t sample = (int32_t)value * 16;  // Reading in 1/16 device units
+  int32_t before = mean16();             // Mean including the sample
+  uint32_t product;                      // Part of the sum contributed by the sample
+  if (count <= 1) {
+    count = 0;
+    _Sum  = 0;
+    _M2   = 0;
+    return;
+  }  // if-then last sample
+  count--;
+  _Sum -= value;
+  product = product16(sample - before, sample - mean16());
+  _M2     = _M2 > product ? _M2 - product : 0;
+}  // of method remove()
+int16_t DSStatistics::average() const {
+  /*!
+    @brief      Return the mean of the samples
+    @return     Mean rounded to device units, 0 without samples
+  */
+  if (count == 0) return (0);
+  return ((_Sum >= 0 ? _Sum + count / 2 : _Sum - count / 2) / count);
+}  // of method average()
+uint16_t DSStatistics::stdDev16() const {
+  /*!
+    @brief      Return the population standard deviation of the samples
+    @return     Standard deviation in 1/16 device units, 0 with fewer than 2 samples
+  */
+  if (count < 2) return (0);
+  return (isqrt(_M2 / count * 16));
+}  // of method stdDev16()
+int32_t DSStatistics::mean16() const {
+  /*!
+    @brief      Return the mean of at least one sample
+    @return     Mean in 1/16 device units, rounded
+  */
+  int32_t sum = _Sum * 16;  // Below 2^30 since count stays below 2^15
+  return ((sum >= 0 ? sum + count / 2 : sum - count / 2) / count);
+}  // of method mean16()
+uint32_t DSStatistics::product16(const int32_t a, const int32_t b) {
+  /*!
+    @brief      Return the product of two deviations in 1/16 device units as 1/16 units squared
+    @details    The deviations from the old and the new mean have the same sign, except when the
+                rounding of the mean puts them on different sides, then 0 is returned
+    @param[in]  a Deviation from the mean before the update
+    @param[in]  b Deviation from the mean after the update
+    @return     Rounded product divided by 16
+  */
+  if ((a < 0) != (b < 0)) return (0);
+  return (((uint32_t)labs(a) * (uint32_t)labs(b) + 8) >> 4);
+}  // of method product16()
+uint16_t DSStatistics::isqrt(uint32_t value) {
+  /*!
+    @brief      Integer square root, computed bit by bit without multiplications
+    @param[in]  value Value to take the root of
+    @return     Largest integer whose square is not greater than value
+  */
+  uint32_t root = 0;
+  uint32_t bit  = 1UL << 30;  // Highest power of 4 in 32 bits
+  while (bit > value) bit >>= 2;
+  while (bit) {
+    if (value >= root + bit) {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }  // if-then-else bit is set in the root
+    bit >>= 2;
+  }  // of while bits remain
+  return ((uint16_t)root);
+}  // of method isqrt()
@@ -26,14 +26,144 @@ directly on the evaporator plate in a refrigerator or freezer and is thus much c
 
 While the DS Family of thermometers are quite accurate, there can still be significant variations between readings.
 The class contains a calibration routine which assumes that all of the devices are at the same temperature and
-will use the DS-Family's 2 User-definable bytes to store offset calibration information which ensures a significant
-improvement in accuracy.\n\n
+stores an offset for each device in its EEPROM table entry, which ensures a significant improvement in accuracy.
+The offset is kept in 1/16 of a device unit and a second calibration at another known temperature with
+CalibrateGain() adds a gain correction, both are applied in fixed point to every calibrated reading. The readings
+of one sample are taken while the devices convert the next one and readings far from the median of a sample are
+left out, so stray readings don't distort the offsets.
+Earlier versions stored the offset in the 2 user-definable bytes TH and TL of the device, such an offset is moved
+into the table once when the device gets its entry. This leaves TH and TL free for their actual purpose: SetDeviceAlarm()
+sets the alarm limits of the devices and after a conversion AlarmSearch() enumerates just the devices whose
+reading is outside of their limits, so only those need to be read.\n\n
 
 The Maxim DSFamily of thermometers use the 1-Wire microLAN protocol. There is an excellent library for 1-Wire,
 written by Paul Stoffregen and located at http://www.pjrc.com/teensy/td_libs_OneWire.html. There is also an
 informative page at http://playground.arduino.cc/Learning/OneWire describing how to use the library. As there
 are parts of the code that are unnecessary for this DS implementation and in order to make this library self-
-sufficient, the code from version 2.0 (extracted 2016-11-23), has been included in this library.
+sufficient, the code from version 2.0 (extracted 2016-11-23), has been included in this library.\n\n
+
+When the 1-Wire pin is fixed at compile time the template class DSFamily_FastPin<pin>, defined in
+"DSFamily_FastPin.h", can be used instead of DSFamily_Class. It resolves the port register and bitmask
+at compile time on the common Atmel processors and otherwise behaves identically. The optional class
+DSFamily_Async, defined in "DSFamily_Async.h", runs scratchpad reads and conversion starts from a
+timer interrupt so that the processor is free between the 1-Wire slots. DSFamily_MultiBus, defined
+in "DSFamily_MultiBus.h", drives up to 8 buses whose pins are on the same port in lockstep, so that
+a sweep of several buses takes as long as a sweep of one. Each instance stores its ROM table at the
+end of the EEPROM unless SetRomRegion() gives it a separate region, which is needed whenever more
+than one instance is used.\n\n
+
+Devices can be put into up to 8 groups, e.g. one per zone of a refrigerator, with SetDeviceGroups().
+The group bits are stored in the ROM table next to the address of the device, so they survive a warm
+start and follow the device when a new scan renumbers it; they are only cleared when the device gets
+a new entry. Each group can be given its own resolution with SetGroupResolution(). Defining
+DS_GROUP_COUNT as a positive number adds a sampling schedule for that many groups: SetGroupPeriod()
+sets how often a group is sampled and ServiceGroups(), called from loop(), starts the conversions of
+the group members when they are due and reads them when they are done, without blocking and without
+touching the devices of other groups. GetGroupStatistics() returns the minimum, maximum, average and
+standard deviation of the last readings of a group.\n\n
+
+Defining DS_SAMPLER_SIZE as a power of 2 up to 128 adds a background sampler with a ring buffer of
+that many readings (8 bytes each). StartSampler() sets the sample rate and ServiceSampler(), called
+from loop() or a periodic task, starts the conversion of all devices on a fixed schedule and reads
+one device per call, each reading being stored with its device number and the time its conversion
+was started. Without parasitic devices the next conversion already runs while the last one is read.
+ReadSample() takes the readings from the buffer without using the bus; the buffer has a single
+producer and a single consumer and needs no locks, so the readings can be drained by another task
+or an interrupt handler. SamplesDropped() counts the readings lost to a full buffer.\n\n
+
+Defining DS_QUEUE_SIZE as a positive number adds a queue of bus requests. QueueRequest() adds a
+conversion, a read, a resolution change or new alarm limits with one of three priorities, and
+ServiceQueue(), called from loop(), runs one request per call: the most urgent one which is ready,
+so urgent reads overtake background configuration. A request never overtakes an earlier one which
+it depends on, e.g. a read waits for the conversion queued before it, and that conversion inherits
+the priority of the read. Requests are merged as they arrive: a conversion joins the one already
+queued, becoming a single Skip-ROM conversion of all devices if they address different devices, a
+read of a device already waiting to be read is dropped and a new setting replaces the queued one.
+A callback set with SetRequestCallback() is told of each request done, including the reading.\n\n
+
+SetDeviceResolution() with "persist" set to "false" only changes the scratchpad of the devices and
+skips the NV write of COPY SCRATCHPAD, so the resolution can be changed as often as needed and
+returns to the stored one at the next power-up. Defining DS_ADAPTIVE_RESOLUTION as a positive
+number lets that many devices switch resolution this way on their own: SetAdaptiveResolution()
+sets the rates of change, and each TakeSnapshot() lowers a device to 9 or 10 bits while its
+reading moves faster than the first rate and restores its own resolution after a number of sweeps
+in a row which moved slower than the second one. Steps of one unit of the resolution in use are
+treated as noise. A device changing fast is then read after 94ms or 188ms instead of 750ms, while
+steady devices keep the full precision. Every COPY SCRATCHPAD, also the broadcast one used when
+setting the resolution or the alarm limits of several devices, briefly puts the own resolution
+back into the scratchpads of lowered devices, so a lowered resolution never reaches NV memory.\n\n
+
+Devices which are plugged in or removed while the program runs are handled by RescanDevices(). It
+compares the bus with the ROM table instead of rebuilding it: new devices are appended, removed ones
+are marked in their table entry and keep their device number, groups and calibration, and a device
+which comes back is given its old number again. Existing device numbers therefore never change and
+only the changed bytes of the table are written. DeviceRemoved() tells if a device is missing.
+VerifyDevice() checks if a single device is still on the bus with one pass of the search algorithm
+along its address, which is much cheaper than a scratchpad read and doesn't retry. VerifyDevices()
+checks every device that way and marks the missing ones as removed, so that subsequent reads and
+snapshots skip them until they answer again.\n\n
+
+A scratchpad read with a bad CRC is repeated, which costs about 11ms each time. SetRetryBudget()
+limits the repeats of each read and of all reads of a sweep together, so a sweep takes a bounded
+time however many devices fail. The errors of each device are scored and a device that keeps
+failing is quarantined: it isn't read anymore but re-probed with a single read after a back-off
+time which doubles with each failed re-probe. GetDeviceStatus() returns the health of a device.\n\n
+
+When temperatures are polled fast, SetReadIntegrity(DS_INTEGRITY_PLAUSIBLE) makes ReadDeviceTemp()
+and TakeSnapshot() read only the 2 temperature bytes of the scratchpad instead of all 9 with the
+CRC, which saves 56 of the 72 read slots. Such readings are checked for plausibility instead and a
+reading which fails a check is read again in full with the CRC.\n\n
+
+The 1-Wire CRC is computed 4 bits at a time with a 16 byte table by default. Defining DS_CRC8_METHOD
+as DS_CRC8_BITWISE saves the table at the cost of speed, DS_CRC8_TABLE uses a 256 byte table and is
+the fastest. The example program "CRC8Benchmark" shows the cycles per byte of each of them.\n\n
+
+The slot primitives reset(), write_bit(), read_bit() and depower() are protected virtual methods and
+form the transport interface of the class. When compiled without the Arduino core (i.e. on a Linux
+host by compiling all library sources together with the program) the library uses the Arduino API
+emulation in "DSFamily_Host.h", which has a virtual clock and an emulated EEPROM, and the class
+DSFamily_Sim in "DSFamily_Sim.h" implements the transport with a simulated network of DS18B20,
+DS18S20, DS1822, DS1825 and DS28EA00 devices. This allows all of the library code to be run, tested
+and benchmarked deterministically off-target. The host program in "extras/HostTests" checks the
+search, warm start, rescans, the queue and the sampler that way and is run by the CI builds.\n\n
+
+Compiling the library with DS_PROFILE defined (e.g. "-DDS_PROFILE" in the build flags) enables the
+bus-time profiler. For each group of public functions (see DSProfileCall) the class then counts the
+calls, reset pulses, bits written and read, CRC failures and retries as well as the microseconds
+spent in 1-Wire slots and in waits for conversions and NV writes. Retries are also counted per
+device. GetProfile(), GetDeviceRetries() and ResetProfile() query and clear the counters. Without
+DS_PROFILE neither the counters nor the functions exist and no code is generated for them.\n\n
+
+The ROM addresses of the devices are stored at the end of the EEPROM and read from there each time
+a device is selected. Defining DS_ROM_CACHE_SIZE as a positive number keeps that many addresses in
+RAM as well, at a cost of 9 bytes each. When all devices fit the table is held completely in RAM,
+otherwise the most recently used addresses are kept. The cache is filled by ScanForDevices() when
+it writes the table, so it is always identical to the EEPROM copy.\n\n
+
+TakeSnapshot() feeds each reading into a DSStatistics object as it arrives, so MinTemperature(),
+MaxTemperature(), AvgTemperature() and StdDevTemperature() only return the stored results and use
+integer arithmetic with 32 bit accumulators. Defining DS_DEVICE_STATISTICS as a positive number
+also keeps running statistics over time for that many devices, each snapshot adding one sample,
+which GetDeviceStatistics() returns.\n\n
+
+A single sensor that is out-of-band or failing can't be handled well by the average. For these
+cases MedianTemperature(), TrimmedMeanTemperature() and RobustTemperature() work on the readings of
+the snapshot: they are copied into a buffer of DS_ROBUST_SIZE values on the stack and ordered only
+as far as needed with an in-place selection, which takes linear time. RobustTemperature() drops all
+readings which are further from the median than a multiple of the median absolute deviation (MAD)
+and averages the rest, DeviceExcluded() then tells which devices were left out. This catches
+sensors stuck at the 85°C power-on value as well as those on an evaporator plate without having to
+know their device numbers.\n\n
+
+Device numbers are of the type DSDeviceNumber, which is a uint8_t for the default DS_MAX_DEVICES of
+254. Defining DS_MAX_DEVICES as a larger number, e.g. "-DDS_MAX_DEVICES=1000" for a bus with
+hundreds of sensors on a Mega2560 or an ESP32, makes device numbers 16 bits wide; the ROM table
+then holds as many devices as the EEPROM space allows. DS_ALL_DEVICES, the highest device number,
+stands for all devices in DeviceStartConvert(), SetDeviceResolution() and SetDeviceAlarm() and for
+no device in the skip parameter of the aggregate functions, so use it instead of UINT8_MAX. The
+buffers of Calibrate() and CalibrateGain() are taken from the heap for the duration of the call and
+sized to the devices found, so every device is calibrated. The host program in
+"extras/ScalingBenchmark" measures the search and sweep times for bus sizes up to 1000 devices.
 
 @section doxygen doxygen configuration
 
@@ -88,19 +218,35 @@ Version| Date       | Developer  | Comments
 */
 // clang-format on
 
-#include <EEPROM.h>  // Access the AVR EEPROM memory
-#if ARDUINO >= 100   // Include depending on version
-  #include "Arduino.h"
+#if !defined(ARDUINO)      // Native host build without the Arduino core
+  #include "DSFamily_Host.h"  // Arduino API emulation with a virtual clock
 #else
-  #include "WProgram.h"
-  #include "pins_arduino.h"  // for digitalPinToBitMask, etc.
+  #include <EEPROM.h>  // Access the AVR EEPROM memory
+  #if ARDUINO >= 100   // Include depending on version
+    #include "Arduino.h"
+  #else
+    #include "WProgram.h"
+    #include "pins_arduino.h"  // for digitalPinToBitMask, etc.
+  #endif
 #endif
-#if defined(__AVR__)  // Platform specific I/O definitions
+#if !defined(ARDUINO)  // Host builds have no pins, the bus is provided by a simulation
+  #define PIN_TO_BASEREG(OneWirePin) (&DSHostIORegister)
+  #define PIN_TO_BITMASK(OneWirePin) (1)
+  #define IO_REG_TYPE uint8_t
+  #define IO_REG_ASM
+  #define DIRECT_READ(base, mask) (((*(base)) & (mask)) ? 1 : 0)
+  #define DIRECT_READ_PORT(base) (*(base))
+  #define DIRECT_MODE_INPUT(base, mask) ((void)(base), (void)(mask))
+  #define DIRECT_MODE_OUTPUT(base, mask) ((void)(base), (void)(mask))
+  #define DIRECT_WRITE_LOW(base, mask) ((void)(base), (void)(mask))
+  #define DIRECT_WRITE_HIGH(base, mask) ((void)(base), (void)(mask))
+#elif defined(__AVR__)  // Platform specific I/O definitions
   #define PIN_TO_BASEREG(OneWirePin) (portInputRegister(digitalPinToPort(OneWirePin)))
   #define PIN_TO_BITMASK(OneWirePin) (digitalPinToBitMask(OneWirePin))
   #define IO_REG_TYPE uint8_t
   #define IO_REG_ASM asm("r30")
   #define DIRECT_READ(base, mask) (((*(base)) & (mask)) ? 1 : 0)
+  #define DIRECT_READ_PORT(base) (*(base))
   #define DIRECT_MODE_INPUT(base, mask) ((*((base) + 1)) &= ~(mask))
   #define DIRECT_MODE_OUTPUT(base, mask) ((*((base) + 1)) |= (mask))
   #define DIRECT_WRITE_LOW(base, mask) ((*((base) + 2)) &= ~(mask))
@@ -111,6 +257,7 @@ Version| Date       | Developer  | Comments
   #define IO_REG_TYPE uint8_t
   #define IO_REG_ASM
   #define DIRECT_READ(base, mask) (*((base) + 512))
+  #define DIRECT_READ_PORT(base) (*((base) + 512))
   #define DIRECT_MODE_INPUT(base, mask) (*((base) + 640) = 0)
   #define DIRECT_MODE_OUTPUT(base, mask) (*((base) + 640) = 1)
   #define DIRECT_WRITE_LOW(base, mask) (*((base) + 256) = 1)
@@ -127,6 +274,7 @@ Version| Date       | Developer  | Comments
   #define IO_REG_TYPE uint32_t
   #define IO_REG_ASM
   #define DIRECT_READ(base, mask) (((*((base) + 15)) & (mask)) ? 1 : 0)
+  #define DIRECT_READ_PORT(base) (*((base) + 15))
   #define DIRECT_MODE_INPUT(base, mask) ((*((base) + 5)) = (mask))
   #define DIRECT_MODE_OUTPUT(base, mask) ((*((base) + 4)) = (mask))
   #define DIRECT_WRITE_LOW(base, mask) ((*((base) + 13)) = (mask))
@@ -143,6 +291,7 @@ Version| Date       | Developer  | Comments
   #define IO_REG_TYPE uint32_t
   #define IO_REG_ASM
   #define DIRECT_READ(base, mask) (((*(base + 4)) & (mask)) ? 1 : 0)  // PORTX + 0x10
+  #define DIRECT_READ_PORT(base) (*(base + 4))                        // PORTX + 0x10
   #define DIRECT_MODE_INPUT(base, mask) ((*(base + 2)) = (mask))      // TRISXSET + 0x08
   #define DIRECT_MODE_OUTPUT(base, mask) ((*(base + 1)) = (mask))     // TRISXCLR + 0x04
   #define DIRECT_WRITE_LOW(base, mask) ((*(base + 8 + 1)) = (mask))   // LATXCLR  + 0x24
@@ -153,54 +302,484 @@ Version| Date       | Developer  | Comments
 #ifndef DSFamily_h
   /** @brief  Guard code to prevent multiple definitions */
   #define DSFamily_h
+  #ifndef DS_MAX_TRACKED_DEVICES
+    /** @brief  Devices whose resolution, deadline and calibration are kept in RAM (7 bytes each) */
+    #define DS_MAX_TRACKED_DEVICES 32
+  #endif
+  #ifndef DS_ROM_CACHE_SIZE
+    /** @brief  ROM addresses cached in RAM (9 bytes each), 0 reads every address from EEPROM */
+    #define DS_ROM_CACHE_SIZE 0
+  #endif
+  #ifndef DS_SNAPSHOT_SIZE
+    /** @brief  Number of device readings held in the internal snapshot buffer */
+    #define DS_SNAPSHOT_SIZE 16
+  #endif
+  #ifndef DS_DEVICE_STATISTICS
+    /** @brief  Devices with running statistics over time (14 bytes each), 0 for none */
+    #define DS_DEVICE_STATISTICS 0
+  #endif
+  #ifndef DS_ROBUST_SIZE
+    /** @brief  Readings sorted on the stack by the median, trimmed mean and outlier functions */
+    #define DS_ROBUST_SIZE 32
+  #endif
+  #ifndef DS_GROUP_COUNT
+    /** @brief  Device groups with a sampling schedule and statistics (20 bytes each), at most 8 */
+    #define DS_GROUP_COUNT 0
+  #endif
+  #ifndef DS_READ_RETRIES
+    /** @brief  Default repeats of a scratchpad read with a bad CRC, see SetRetryBudget() */
+    #define DS_READ_RETRIES 9
+  #endif
+  #ifndef DS_SWEEP_RETRIES
+    /** @brief  Default repeats shared by all reads of a sweep, UINT8_MAX for no limit */
+    #define DS_SWEEP_RETRIES 20
+  #endif
+  /** @brief  crc8() computes the CRC one bit at a time, without a table */
+  #define DS_CRC8_BITWISE 0
+  /** @brief  crc8() computes the CRC 4 bits at a time with a 16 byte table */
+  #define DS_CRC8_NIBBLE 1
+  /** @brief  crc8() computes the CRC a byte at a time with a 256 byte table */
+  #define DS_CRC8_TABLE 2
+  #ifndef DS_CRC8_METHOD
+    /** @brief  CRC implementation used for all checks: DS_CRC8_BITWISE, _NIBBLE or _TABLE */
+    #define DS_CRC8_METHOD DS_CRC8_NIBBLE
+  #endif
+  #ifndef DS_PLAUSIBLE_DELTA
+    /** @brief  Largest change from the last reading accepted without CRC, in 1/16°C */
+    #define DS_PLAUSIBLE_DELTA 160
+  #endif
+  #ifndef DS_QUARANTINE_SCORE
+    /** @brief  Error score which quarantines a tracked device (4 bytes each), 0 for none */
+    #define DS_QUARANTINE_SCORE 16
+  #endif
+  #ifndef DS_MAX_DEVICES
+    /** @brief  Most devices on a bus, above 254 the device numbers take 16 bits */
+    #define DS_MAX_DEVICES 254
+  #endif
+  #if DS_MAX_DEVICES > 254
+/** @brief  Device number, wide enough for DS_MAX_DEVICES and DS_ALL_DEVICES */
+typedef uint16_t DSDeviceNumber;
+  #else
+/** @brief  Device number, wide enough for DS_MAX_DEVICES and DS_ALL_DEVICES */
+typedef uint8_t DSDeviceNumber;
+  #endif
+  /** @brief  Device number standing for all devices, or for no device to skip */
+  #define DS_ALL_DEVICES ((DSDeviceNumber)-1)
+  #ifndef DS_SAMPLER_SIZE
+    /** @brief  Readings in the ring buffer of the background sampler, a power of 2 up to 128 */
+    #define DS_SAMPLER_SIZE 0
+  #endif
+  #if DS_SAMPLER_SIZE > 128 || (DS_SAMPLER_SIZE & (DS_SAMPLER_SIZE - 1))
+    #error "DS_SAMPLER_SIZE must be 0 or a power of 2 up to 128"
+  #endif
+  #ifndef DS_QUEUE_SIZE
+    /** @brief  Bus requests held by the transaction queue (6 bytes each), 0 for no queue */
+    #define DS_QUEUE_SIZE 0
+  #endif
+  #if DS_QUEUE_SIZE > 255
+    #error "DS_QUEUE_SIZE must be at most 255"
+  #endif
+  #ifndef DS_ADAPTIVE_RESOLUTION
+    /** @brief  Devices whose resolution follows their rate of change (2 bytes each), 0 for none */
+    #define DS_ADAPTIVE_RESOLUTION 0
+  #endif
+  #if DS_ADAPTIVE_RESOLUTION > DS_MAX_TRACKED_DEVICES
+    #error "DS_ADAPTIVE_RESOLUTION can't be larger than DS_MAX_TRACKED_DEVICES"
+  #endif
+/***************************************************************************************************
+** Declare the constants shared by the source files of the library. A region of SetRomRegion()    **
+** for maxDevices entries takes DS_TABLE_HEADER_SIZE + maxDevices * DS_ROM_ENTRY_SIZE bytes       **
+***************************************************************************************************/
+const uint8_t DS_START_CONVERT{0x44};    ///< Command to start conversion
+const uint8_t DS_READ_SCRATCHPAD{0xBE};  ///< Command to read the temperature
+const uint8_t DS_SKIP_ROM{0xCC};         ///< Skip the ROM address on 1-Wire
+const uint8_t DS_SELECT_ROM{0x55};       ///< Select the ROM address on 1-Wire
+const int16_t DS_BAD_TEMPERATURE{-880};  ///< Reading of a device which couldn't be read, -55°C
+const uint8_t DS_TABLE_HEADER_SIZE{6};   ///< ROM table header: magic, layout, count, flags, CRC
+const uint8_t DS_ROM_ENTRY_SIZE{13};     ///< EEPROM bytes per ROM table entry
+/*!
+ * @brief   States of the temperature conversion as returned by the non-blocking poll() method
+ */
+enum DSConversionState : uint8_t {
+  DS_CONVERSION_IDLE = 0,  ///< No conversion has been started
+  DS_CONVERSION_ACTIVE,    ///< Conversion is still running
+  DS_CONVERSION_DONE,      ///< Conversion has finished and results can be read
+  DS_CONVERSION_TIMEOUT    ///< Bus didn't signal completion in time, results might be stale
+};
+/*!
+ * @brief   How temperature reads are checked, see SetReadIntegrity()
+ */
+enum DSReadIntegrity : uint8_t {
+  DS_INTEGRITY_CRC = 0,   ///< Read the whole scratchpad and check its CRC
+  DS_INTEGRITY_PLAUSIBLE  ///< Read the temperature bytes only and check their plausibility
+};
+/*!
+ * @brief   Health of a device as returned by GetDeviceStatus()
+ */
+enum DSDeviceStatus : uint8_t {
+  DS_DEVICE_OK = 0,       ///< Recent reads were good
+  DS_DEVICE_DEGRADED,     ///< Recent reads had bad CRCs, but the device isn't quarantined
+  DS_DEVICE_QUARANTINED,  ///< Too many errors, the device is only re-probed now and then
+  DS_DEVICE_REMOVED       ///< Marked as removed from the bus, or no such device
+};
+  #if defined(DS_PROFILE)
+/*!
+ * @brief   Groups of public functions whose bus usage is profiled separately
+ * @details Bus activity is charged to the outermost public function, so the slots used by
+ *          ScanForDevices() to set the resolution count towards DS_CALL_SCAN
+ */
+enum DSProfileCall : uint8_t {
+  DS_CALL_SCAN = 0,       ///< ScanForDevices()
+  DS_CALL_READ_TEMP,      ///< ReadDeviceTemp()
+  DS_CALL_START_CONVERT,  ///< DeviceStartConvert()
+  DS_CALL_POLL,           ///< poll()
+  DS_CALL_SNAPSHOT,       ///< TakeSnapshot() and the Min/Max/Avg/StdDev functions
+  DS_CALL_RESOLUTION,     ///< SetDeviceResolution() and GetDeviceResolution()
+  DS_CALL_CALIBRATION,    ///< Calibrate(), CalibrateGain() and the calibration accessors
+  DS_CALL_GROUPS,         ///< ServiceGroups() and the other device group functions
+  DS_CALL_ALARM,          ///< SetDeviceAlarm() and AlarmSearch()
+  DS_CALL_SAMPLER,        ///< ServiceSampler() and StartSampler()
+  DS_CALL_QUEUE,          ///< ServiceQueue() and the requests it runs
+  DS_CALL_OTHER,          ///< Everything else
+  DS_CALL_COUNT           ///< Number of groups
+};
+/*!
+ * @brief   Profiling counters for one group of public functions
+ */
+struct DSProfileCounters {
+  uint32_t calls;        ///< Number of calls
+  uint32_t resets;       ///< Reset pulses
+  uint32_t bitsWritten;  ///< Write slots
+  uint32_t bitsRead;     ///< Read slots
+  uint32_t crcFailures;  ///< Scratchpad reads with a bad CRC
+  uint32_t retries;      ///< Repeated scratchpad reads and unsuccessful search passes
+  uint32_t slotMicros;   ///< Microseconds spent in reset, write and read slots
+  uint32_t waitMicros;   ///< Microseconds spent waiting for conversions and NV writes
+};
+  #endif
+/*!
+ * @class   DSStatistics
+ * @brief   Streaming integer statistics of temperature readings
+ * @details The variance is updated with Welford's method for every sample, so no readings need to
+ *          be kept. The sum of the samples and the sum of squared deviations are held in 32 bit
+ *          integers; when either gets too large both are halved together with the count, which
+ *          keeps the mean and variance but gives new samples more weight
+ */
+class DSStatistics {
+ public:
+  uint16_t count   = 0;          ///< Number of samples
+  int16_t  minimum = INT16_MAX;  ///< Lowest sample
+  int16_t  maximum = INT16_MIN;  ///< Highest sample
+
+  void     clear();
+  void     add(const int16_t value);
+  void     remove(const int16_t value);
+  int16_t  average() const;
+  uint16_t stdDev16() const;
+
+ private:
+  int32_t  _Sum = 0;  ///< Sum of the samples in device units
+  uint32_t _M2  = 0;  ///< Sum of squared deviations from the mean in 1/16 units squared
+
+  int32_t         mean16() const;
+  static uint32_t product16(const int32_t a, const int32_t b);
+  static uint16_t isqrt(uint32_t value);
+};  // of DSStatistics class definition
+  #if DS_SAMPLER_SIZE > 0
+/*!
+ * @brief   One reading taken by the background sampler, see ServiceSampler()
+ */
+struct DSSample {
+  uint32_t       timestamp;    ///< millis() when the conversion of the reading was started
+  DSDeviceNumber device;       ///< Device number
+  int16_t        temperature;  ///< Reading in device units, DS_BAD_TEMPERATURE if not read
+};
+  #endif
+  #if DS_QUEUE_SIZE > 0
+/*!
+ * @brief   Bus operations which can be queued with QueueRequest()
+ */
+enum DSRequestType : uint8_t {
+  DS_REQUEST_CONVERT = 0,  ///< Start a conversion, like DeviceStartConvert()
+  DS_REQUEST_READ,         ///< Read the temperature into the value, like ReadDeviceTemp()
+  DS_REQUEST_RESOLUTION,   ///< Set the resolution in bits given as value
+  DS_REQUEST_ALARM         ///< Set the alarm limits, TL in the low and TH in the high byte
+};
+/*!
+ * @brief   Priorities of queued requests, lower values run first
+ */
+enum DSRequestPriority : uint8_t {
+  DS_PRIORITY_URGENT = 0,  ///< Readings the program is waiting for
+  DS_PRIORITY_NORMAL,      ///< Regular conversions and reads
+  DS_PRIORITY_BACKGROUND   ///< Configuration which can wait, e.g. resolution and alarm limits
+};
+/*!
+ * @brief   One queued bus request, see QueueRequest() and ServiceQueue()
+ */
+struct DSRequest {
+  uint8_t        type;      ///< DSRequestType
+  uint8_t        priority;  ///< DSRequestPriority
+  DSDeviceNumber device;    ///< Device number, DS_ALL_DEVICES for all devices
+  int16_t        value;     ///< Parameter, or the reading once a read has been done
+};
+/** @brief  Called by ServiceQueue() when a request has been done */
+typedef void (*DSRequestCallback)(const DSRequest &request);
+  #endif
 /*!
  * @class   DSFamily_Class
  * @brief   Access the available DS-Family devices on the 1-Wire bus
  */
 class DSFamily_Class {
+  friend class DSFamily_Async;     // Interrupt engine uses the same pin
+  friend class DSFamily_MultiBus;  // Lockstep driver uses the pin and the ROM table
+
  public:
   DSFamily_Class(const uint8_t OneWirePin, const uint8_t ReserveRom = 0);
-  ~DSFamily_Class();
-  uint16_t ConversionMillis;          ///< Current conversion milliseconds
-  uint8_t  ThermometersFound = 0;     ///< Number of Devices  discovered
-  bool     Parasitic         = true;  ///< One or more parasitic devices present
-
-  uint8_t ScanForDevices();
-  int16_t ReadDeviceTemp(const uint8_t deviceNumber, const bool raw = false);
-  void    DeviceStartConvert(const uint8_t deviceNumber = UINT8_MAX, const bool WaitSwitch = false);
-  void    Calibrate(const uint8_t iterations = 30, const int16_t CalTemp = INT16_MAX);
-  int8_t  GetDeviceCalibration(const uint8_t deviceNumber);
-  void    SetDeviceCalibration(const uint8_t deviceNumber, const int8_t offset);
-  int16_t MinTemperature(const uint8_t skipDeviceNumber = UINT8_MAX);
-  int16_t MaxTemperature(const uint8_t skipDeviceNumber = UINT8_MAX);
-  int16_t AvgTemperature(const uint8_t skipDeviceNumber = UINT8_MAX);
-  float   StdDevTemperature(const uint8_t skipDeviceNumber = UINT8_MAX);
-  void    SetDeviceResolution(const uint8_t deviceNumber, uint8_t resolution);
-  uint8_t GetDeviceResolution(const uint8_t deviceNumber);
-  void    GetDeviceROM(const uint8_t deviceNumber, uint8_t ROMBuffer[8]);
-  uint8_t crc8(const uint8_t *addr, uint8_t len);
+  virtual ~DSFamily_Class();
+  uint16_t       ConversionMillis;           ///< Longest conversion milliseconds of all devices
+  DSDeviceNumber ThermometersFound = 0;      ///< Number of Devices  discovered
+  bool           Parasitic         = true;   ///< One or more parasitic devices present
+  uint32_t       SnapshotMillis    = 0;      ///< millis() value when the last snapshot was taken
+  bool           SnapshotValid     = false;  ///< Snapshot holds results of the current conversion
+
+  DSDeviceNumber ScanForDevices(const bool warmStart = false);
+  DSDeviceNumber RescanDevices();
+  bool           DeviceRemoved(const DSDeviceNumber deviceNumber);
+  bool           VerifyDevice(const DSDeviceNumber deviceNumber);
+  DSDeviceNumber VerifyDevices();
+  void           SetRetryBudget(const uint8_t perRead, const uint8_t perSweep = UINT8_MAX);
+  uint8_t        GetDeviceStatus(const DSDeviceNumber deviceNumber);
+  void           SetReadIntegrity(const uint8_t integrity);
+  int16_t        ReadDeviceTemp(const DSDeviceNumber deviceNumber, const bool raw = false);
+  void           DeviceStartConvert(const DSDeviceNumber deviceNumber = DS_ALL_DEVICES,
+                                    const bool           WaitSwitch   = false);
+  uint8_t        poll();
+  void           Calibrate(const uint8_t iterations = 30, const int16_t CalTemp = INT16_MAX);
+  DSDeviceNumber CalibrateGain(const int16_t CalTemp, const int16_t firstCalTemp,
+                               const uint8_t iterations = 30);
+  int8_t         GetDeviceCalibration(const DSDeviceNumber deviceNumber);
+  void           SetDeviceCalibration(const DSDeviceNumber deviceNumber, const int8_t offset);
+  void           SetDeviceCalibration(const DSDeviceNumber deviceNumber, const int16_t offset,
+                                      const int16_t gain);
+  int16_t        GetDeviceOffset(const DSDeviceNumber deviceNumber);
+  int16_t        GetDeviceGain(const DSDeviceNumber deviceNumber);
+  void           SetDeviceAlarm(const DSDeviceNumber deviceNumber, const int8_t low,
+                                const int8_t high);
+  DSDeviceNumber AlarmSearch(DSDeviceNumber devices[], const DSDeviceNumber maxDevices);
+  int16_t        MinTemperature(const DSDeviceNumber skipDeviceNumber = DS_ALL_DEVICES);
+  int16_t        MaxTemperature(const DSDeviceNumber skipDeviceNumber = DS_ALL_DEVICES);
+  int16_t        AvgTemperature(const DSDeviceNumber skipDeviceNumber = DS_ALL_DEVICES);
+  float          StdDevTemperature(const DSDeviceNumber skipDeviceNumber = DS_ALL_DEVICES);
+  int16_t        MedianTemperature();
+  int16_t        TrimmedMeanTemperature(const uint8_t trimPercent = 20);
+  int16_t        RobustTemperature(const uint8_t madLimit = 3);
+  bool           DeviceExcluded(const DSDeviceNumber deviceNumber);
+  DSDeviceNumber TakeSnapshot();
+  int16_t        SnapshotTemp(const DSDeviceNumber deviceNumber);
+  void           SetSnapshotBuffer(int16_t *buffer, const DSDeviceNumber bufferSize);
+  void           SetDeviceResolution(const DSDeviceNumber deviceNumber, uint8_t resolution,
+                                     const bool persist = true);
+  uint8_t        GetDeviceResolution(const DSDeviceNumber deviceNumber);
+  void           GetDeviceROM(const DSDeviceNumber deviceNumber, uint8_t ROMBuffer[8]);
+  uint8_t        crc8(const uint8_t *addr, uint8_t len);
+  void           SetRomRegion(const uint16_t endAddress, const DSDeviceNumber maxDevices);
+  void           SetDeviceGroups(const DSDeviceNumber deviceNumber, const uint8_t groups);
+  uint8_t        GetDeviceGroups(const DSDeviceNumber deviceNumber);
+  void           SetGroupResolution(const uint8_t groups, const uint8_t resolution);
+  #if DS_GROUP_COUNT > 0
+  void         SetGroupPeriod(const uint8_t group, const uint16_t periodMillis);
+  uint8_t      ServiceGroups();
+  DSStatistics GetGroupStatistics(const uint8_t group);
+  #endif
+  #if DS_DEVICE_STATISTICS > 0
+  DSStatistics GetDeviceStatistics(const DSDeviceNumber deviceNumber);
+  void         ResetStatistics();
+  #endif
+  #if DS_SAMPLER_SIZE > 0
+  void     StartSampler(const uint16_t periodMillis, const bool raw = false);
+  uint8_t  ServiceSampler();
+  bool     ReadSample(DSSample &sample);
+  uint8_t  SamplesAvailable();
+  uint16_t SamplesDropped();
+  #endif
+  #if DS_QUEUE_SIZE > 0
+  bool    QueueRequest(const uint8_t type, const DSDeviceNumber deviceNumber,
+                       const int16_t value = 0, const uint8_t priority = DS_PRIORITY_NORMAL);
+  uint8_t ServiceQueue();
+  uint8_t RequestsQueued();
+  void    SetRequestCallback(DSRequestCallback callback);
+  #endif
+  #if DS_ADAPTIVE_RESOLUTION > 0
+  void SetAdaptiveResolution(const uint16_t fastRate, const uint16_t calmRate,
+                             const uint8_t fastResolution = 10, const uint8_t calmSweeps = 3);
+  #endif
+  #if defined(DS_PROFILE)
+  const DSProfileCounters &GetProfile(const uint8_t call);
+  uint16_t                 GetDeviceRetries(const DSDeviceNumber deviceNumber);
+  void                     ResetProfile();
+  #endif
+
+  static uint8_t crc8Update(const uint8_t crc, const uint8_t data);
+  static uint8_t crc8Bitwise(uint8_t crc, uint8_t data);
+  static uint8_t crc8Nibble(uint8_t crc, const uint8_t data);
+  static uint8_t crc8Table(const uint8_t crc, const uint8_t data);
+
+ protected:
+  virtual uint8_t reset(void);
+  virtual void    write_bit(uint8_t v);
+  virtual uint8_t read_bit(void);
+  virtual void    depower(void);
 
  private:
-  uint8_t               _MaxThermometers;                ///< Number of devices found/stord
-  uint32_t              _ConvStartTime;                  ///< Conversion start time
-  bool                  _LastCommandWasConvert = false;  ///< Unset when other commands issued
-  IO_REG_TYPE           bitmask;                         ///< Bitmask for 1-Wire IO
-  volatile IO_REG_TYPE *baseReg;                         ///< Base register
-  unsigned char         ROM_NO[8];                       ///< global search state array
-  uint8_t               LastDiscrepancy;                 ///< 1-Wire internal value
-  uint8_t               LastFamilyDiscrepancy;           ///< 1-Wire internal value
-  uint8_t               LastDeviceFlag;                  ///< 1-Wire internal value
-
-  boolean Read1WireScratchpad(const uint8_t deviceNumber, uint8_t bf[9]);
-  void    SelectDevice(const uint8_t deviceNumber);
-  void    ParasiticWait();
-  void    reset_search();
-  uint8_t reset(void);
-  void    write_bit(uint8_t v);
-  uint8_t read_bit(void);
-  void    write_byte(uint8_t v, uint8_t power = 0);
-  uint8_t read_byte();
-  void    select(const uint8_t rom[8]);
-  uint8_t search(uint8_t *newAddr);
+  DSDeviceNumber        _MaxThermometers;                   ///< Number of devices found/stord
+  uint16_t              _RomTableEnd;                       ///< EEPROM address of the table header
+  uint8_t               _ReserveRom;                        ///< EEPROM bytes kept free at the start
+  uint32_t              _ConvStartTime;                     ///< Conversion start time
+  bool                  _LastCommandWasConvert = false;     ///< Unset when other commands issued
+  bool                  _OtherDevices          = false;     ///< Bus has non-thermometer devices
+  uint8_t               _ConvState{DS_CONVERSION_IDLE};     ///< Current conversion state
+  uint16_t              _ConvDuration;                      ///< Duration of active conversions
+  int16_t               _SnapshotBuffer[DS_SNAPSHOT_SIZE];  ///< Internal snapshot storage
+  int16_t              *_Snapshot;                          ///< Snapshot buffer in use
+  DSDeviceNumber        _SnapshotSize;                      ///< Entries in snapshot buffer
+  DSStatistics          _SnapshotStats;                     ///< Statistics of the snapshot
+  IO_REG_TYPE           bitmask;                            ///< Bitmask for 1-Wire IO
+  volatile IO_REG_TYPE *baseReg;                            ///< Base register
+  unsigned char         ROM_NO[8];                          ///< global search state array
+  uint8_t               LastDiscrepancy;                    ///< 1-Wire internal value
+  uint8_t               LastFamilyDiscrepancy;              ///< 1-Wire internal value
+  uint8_t               LastDeviceFlag;                     ///< 1-Wire internal value
+  uint8_t               _ReadRetries{DS_READ_RETRIES};      ///< Repeats of a single read
+  uint8_t               _SweepRetries{DS_SWEEP_RETRIES};    ///< Repeats of all reads of a sweep
+  uint8_t               _SweepRetriesLeft{UINT8_MAX};       ///< Left in this sweep, MAX if none
+  uint8_t               _ReadIntegrity{DS_INTEGRITY_CRC};   ///< Check of temperature reads
+
+  uint8_t  _DeviceResolution[(DS_MAX_TRACKED_DEVICES + 3) / 4];  ///< 2 bits/device, 12 - bits
+  uint8_t  _DeviceConverting[(DS_MAX_TRACKED_DEVICES + 7) / 8];  ///< 1 bit/device, busy flag
+  uint16_t _DeviceDeadline[DS_MAX_TRACKED_DEVICES];              ///< millis() & 0xFFFF at end
+  int16_t  _DeviceOffset[DS_MAX_TRACKED_DEVICES];                ///< Calibration from the table
+  int16_t  _DeviceGain[DS_MAX_TRACKED_DEVICES];                  ///< Gain from the table
+  uint8_t  _DeviceExcluded[(DS_ROBUST_SIZE + 7) / 8];            ///< 1 bit/device, outlier flag
+  uint8_t  _DeviceRemoved[(DS_MAX_DEVICES + 7) / 8];             ///< 1 bit/device, tombstone
+  #if DS_QUARANTINE_SCORE > 0
+  uint8_t  _DeviceScore[DS_MAX_TRACKED_DEVICES];    ///< Error score of the recent reads
+  uint8_t  _DeviceBackoff[DS_MAX_TRACKED_DEVICES];  ///< Quarantined, log2 of re-probe interval + 1
+  uint16_t _DeviceProbe[DS_MAX_TRACKED_DEVICES];    ///< Re-probe time in millis() / 1024
+  #endif
+  #if DS_DEVICE_STATISTICS > 0
+  DSStatistics _DeviceStats[DS_DEVICE_STATISTICS];  ///< Running statistics per device
+  #endif
+  #if DS_GROUP_COUNT > 0
+  DSStatistics _GroupStats[DS_GROUP_COUNT];   ///< Readings of the last sweep of each group
+  uint32_t     _GroupDue[DS_GROUP_COUNT];     ///< millis() when the next conversion is started
+  uint16_t     _GroupPeriod[DS_GROUP_COUNT];  ///< Sampling period in ms, 0 if not scheduled
+  uint8_t      _GroupConverting = 0;          ///< 1 bit/group, conversion started
+  #endif
+  #if DS_SAMPLER_SIZE > 0
+  DSSample       _Samples[DS_SAMPLER_SIZE];            ///< Ring buffer of the sampled readings
+  uint8_t        _SampleHead        = 0;               ///< Readings stored, producer writes only
+  uint8_t        _SampleTail        = 0;               ///< Readings taken, consumer writes only
+  uint16_t       _SamplesDropped    = 0;               ///< Readings lost to a full ring buffer
+  uint32_t       _SamplerDue;                          ///< millis() to start the next conversion
+  uint32_t       _SamplerStart;                        ///< millis() at start of the next one
+  uint32_t       _SamplerTime;                         ///< millis() at start of the one read
+  uint16_t       _SamplerPeriod     = 0;               ///< Sampling period in ms, 0 if stopped
+  DSDeviceNumber _SamplerNext       = DS_ALL_DEVICES;  ///< Next device to read, all if none
+  bool           _SamplerConverting = false;           ///< Conversion of the sampler is running
+  bool           _SamplerRaw        = false;           ///< Store readings without the calibration
+  #endif
+  #if DS_QUEUE_SIZE > 0
+  DSRequest         _Requests[DS_QUEUE_SIZE];    ///< Queued requests in the order they arrived
+  uint8_t           _RequestCount    = 0;        ///< Number of queued requests
+  DSRequestCallback _RequestCallback = nullptr;  ///< Told about each request done
+  #endif
+  #if DS_ADAPTIVE_RESOLUTION > 0
+  uint8_t  _AdaptiveCalm[DS_ADAPTIVE_RESOLUTION];    ///< Calm sweeps in a row of each device
+  uint8_t  _AdaptiveStored[DS_ADAPTIVE_RESOLUTION];  ///< Own resolution while lowered, else 0
+  uint16_t _AdaptiveFast  = 0;                       ///< Rate which lowers the resolution, 0 if off
+  uint16_t _AdaptiveSlow  = 0;                       ///< Rate up to which a sweep counts as calm
+  uint8_t  _AdaptiveBits  = 10;                      ///< Resolution while changing fast
+  uint8_t  _AdaptiveCount = 3;                       ///< Calm sweeps before restoring resolution
+  uint32_t _AdaptiveTime  = 0;                       ///< Start of the conversion of the last sweep
+  #endif
+  #if defined(DS_PROFILE)
+  class ProfileScope;                                        // Charges bus time to a public call
+  DSProfileCounters _Profile[DS_CALL_COUNT];                 ///< Counters per DSProfileCall
+  uint16_t          _DeviceRetries[DS_MAX_TRACKED_DEVICES];  ///< Scratchpad retries per device
+  uint8_t           _ProfileCall{DS_CALL_OTHER};             ///< Group being charged
+  #endif
+  #if DS_ROM_CACHE_SIZE > 0
+  uint8_t        _RomCache[DS_ROM_CACHE_SIZE][8];     ///< Cached ROM addresses
+  DSDeviceNumber _RomCacheDevice[DS_ROM_CACHE_SIZE];  ///< Device of each entry, recent ones first
+  bool           _RomCacheFull = false;               ///< All devices fit, entry n holds device n
+  #endif
+
+  boolean  Read1WireScratchpad(const DSDeviceNumber deviceNumber, uint8_t bf[9]);
+  uint8_t  ReadAttempts(const DSDeviceNumber deviceNumber);
+  void     ReadFinished(const DSDeviceNumber deviceNumber, const bool good, const uint8_t repeats);
+  bool     ReadPlausible(const DSDeviceNumber deviceNumber, uint8_t buffer[9]);
+  bool     ConfirmDevice(const DSDeviceNumber deviceNumber);
+  bool     ThermometerFamily(const uint8_t family);
+  void     FamilySkip();
+  void     MarkRemoved(const DSDeviceNumber deviceNumber, const bool removed);
+  int16_t  ScratchpadTemp(const DSDeviceNumber deviceNumber, const uint8_t buffer[9],
+                          const bool raw);
+  bool     CalibrationReadings(const uint8_t iterations, int16_t means[]);
+  int16_t  ReadEntryWord(const DSDeviceNumber deviceNumber, const uint8_t offset);
+  void     WriteEntryWord(const DSDeviceNumber deviceNumber, const uint8_t offset,
+                          const int16_t value);
+  bool     SnapshotReading(const DSDeviceNumber deviceNumber, const int16_t temperature);
+  #if DS_SAMPLER_SIZE > 0
+  void     PushSample(const DSDeviceNumber deviceNumber, const int16_t temperature);
+  #endif
+  #if DS_QUEUE_SIZE > 0
+  bool     RequestsConflict(const DSRequest &earlier, const DSRequest &later);
+  bool     RequestReady(const uint8_t index);
+  void     InheritPriorities();
+  #endif
+  #if DS_ADAPTIVE_RESOLUTION > 0
+  void     AdaptResolution(const DSDeviceNumber deviceNumber, const int16_t temperature,
+                           const uint32_t elapsed);
+  void     WriteAdaptedResolutions(const DSDeviceNumber deviceNumber, const bool adapted);
+  #endif
+  DSDeviceNumber RobustDevices();
+  DSDeviceNumber RobustReadings(int16_t values[DS_ROBUST_SIZE]);
+  int16_t        SelectNth(int16_t values[], const DSDeviceNumber count, const DSDeviceNumber n);
+  int16_t        MedianOf(int16_t values[], const DSDeviceNumber count);
+  void           SelectDevice(const DSDeviceNumber deviceNumber);
+  bool           WriteScratchpad(const DSDeviceNumber deviceNumber, const uint8_t current[9],
+                                 const uint8_t userByte1, const uint8_t userByte2,
+                                 const uint8_t config);
+  void           CopyScratchpad(const DSDeviceNumber deviceNumber);
+  void           ReadRomEntry(const DSDeviceNumber deviceNumber, uint8_t rom[8]);
+  bool           WriteRomEntry(const DSDeviceNumber deviceNumber, const uint8_t rom[8]);
+  void           ImportCalibration(const DSDeviceNumber deviceNumber);
+  bool           EntryHoldsDevice(const DSDeviceNumber entry, const uint8_t rom[8]);
+  void           SwapRomEntries(const DSDeviceNumber first, const DSDeviceNumber second);
+  void           WriteResolutions(const DSDeviceNumber first, const DSDeviceNumber last,
+                                  const uint8_t groups, const uint8_t resolution,
+                                  const bool persist = true);
+  void           ClearRomCache();
+  void           FillRomCache();
+  uint16_t       RomEntryAddress(const DSDeviceNumber deviceNumber);
+  void           WriteRomHeader();
+  DSDeviceNumber StoredDevices();
+  bool           LoadRomTable();
+  void           ParasiticWait();
+  void           WaitForConversion();
+  bool           DeviceConverting(const DSDeviceNumber deviceNumber);
+  void           ConversionStarted(const DSDeviceNumber deviceNumber);
+  void           StartDeviceDeadline(const DSDeviceNumber deviceNumber, const uint32_t now);
+  uint8_t        TrackedResolution(const DSDeviceNumber deviceNumber);
+  void           SetTrackedResolution(const DSDeviceNumber deviceNumber, const uint8_t resolution);
+  void           reset_search();
+  uint8_t        bus_reset();
+  void           bus_write_bit(uint8_t v);
+  uint8_t        bus_read_bit();
+  void           write_byte(uint8_t v, uint8_t power = 0);
+  uint8_t        read_byte();
+  void           select(const uint8_t rom[8]);
+  bool           verify(const uint8_t rom[8]);
+  uint8_t        search(uint8_t *newAddr, const uint8_t command);
 };  // of DSFamily class definition
 #endif
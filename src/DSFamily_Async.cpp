@@ -0,0 +1,242 @@
+/*! @file DSFamily_Async.cpp
+ @section DSFamily_Asynccpp_intro_section Description
+
+Interrupt-driven 1-Wire transfer engine for the DSFamily library\n\n
+See the header file DSFamily_Async.h for details
+*/
+#include "DSFamily_Async.h"  // Include the header definition
+/***************************************************************************************************
+** Declare constants used in the class, but ones that are not visible as public or private class  **
+** components                                                                                     **
+***************************************************************************************************/
+const uint8_t DS_PHASE_RESET{0};     ///< Pull the line low for the reset pulse
+const uint8_t DS_PHASE_RELEASE{1};   ///< Release the line after the reset pulse
+const uint8_t DS_PHASE_PRESENCE{2};  ///< Sample the presence pulse
+const uint8_t DS_PHASE_SLOT{3};      ///< Start the next write or read slot
+const uint8_t DS_PHASE_WRITE0{4};    ///< Release the line at the end of a "0" write slot
+#if defined(DS_ASYNC_AVAILABLE)
+  #if F_CPU > 16000000L
+const uint8_t DS_TIMER_PRESCALE{64};      ///< Timer2 clock divider
+const uint8_t DS_TIMER_CLOCK{_BV(CS22)};  ///< Timer2 clock select bits for /64
+  #else
+const uint8_t DS_TIMER_PRESCALE{32};                 ///< Timer2 clock divider
+const uint8_t DS_TIMER_CLOCK{_BV(CS21) | _BV(CS20)};  ///< Timer2 clock select bits for /32
+  #endif
+#endif
+
+DSFamily_Async::DSFamily_Async(DSFamily_Class &bus) : _Bus(&bus) {
+  /*!
+    @brief     Class constructor
+    @param[in] bus The DSFamily_Class instance whose 1-Wire pin and device table are used
+  */
+}  // of class constructor
+bool DSFamily_Async::begin() {
+  /*!
+    @brief   Prepare Timer2 for use by the engine
+    @details The timer is set to CTC mode and left stopped until a transaction is queued
+    @return  "true" if the engine is available on this platform
+  */
+#if defined(DS_ASYNC_AVAILABLE)
+  noInterrupts();
+  TCCR2B = 0;           // Stop the timer
+  TCCR2A = _BV(WGM21);  // Clear timer on compare match mode
+  TIMSK2 = 0;           // No timer interrupts yet
+  interrupts();
+  return (true);
+#else
+  return (false);
+#endif
+}  // of method begin()
+bool DSFamily_Async::queue(DSFamily_Transaction &transaction) {
+  /*!
+    @brief     Add a transaction to the queue
+    @details   If the bus is idle the transaction starts immediately, otherwise it starts once the
+               transactions queued before it have finished. The interrupt state is saved and
+               restored rather than enabled, so this may also be called from a completion callback
+    @param[in] transaction Transaction to run, must remain valid until it has finished
+    @return    "false" if the queue is full or the engine isn't available
+  */
+#if defined(DS_ASYNC_AVAILABLE)
+  bool    queued = false;
+  uint8_t sreg   = SREG;  // Interrupts are already off inside the ISR
+  noInterrupts();
+  if (_Count < DS_ASYNC_QUEUE_SIZE) {
+    transaction.status                             = DS_TX_QUEUED;
+    _Queue[(_Head + _Count) % DS_ASYNC_QUEUE_SIZE] = &transaction;
+    _Count++;
+    if (!_Active) startNext();  // Bus was idle, start right away
+    queued = true;
+  }  // if-then room in the queue
+  SREG = sreg;
+  return (queued);
+#else
+  (void)transaction;
+  return (false);
+#endif
+}  // of method queue()
+bool DSFamily_Async::queueReadScratchpad(DSFamily_Transaction &transaction,
+                                         const DSDeviceNumber  deviceNumber) {
+  /*!
+    @brief     Queue a "select + read scratchpad" transaction for a device
+    @details   On completion the 9 scratchpad bytes are in transaction.rx and the status is either
+               DS_TX_DONE or DS_TX_CRC_ERROR, the CRC being computed bit by bit as the data arrives
+    @param[in] transaction Transaction to fill and queue
+    @param[in] deviceNumber 1-Wire device number
+    @return    "false" if the transaction couldn't be queued
+  */
+  if (transaction.status == DS_TX_QUEUED || transaction.status == DS_TX_ACTIVE) return (false);
+  transaction.tx[0] = DS_SELECT_ROM;                     // Select the device
+  _Bus->GetDeviceROM(deviceNumber, &transaction.tx[1]);  // using its ROM address
+  transaction.tx[9]    = DS_READ_SCRATCHPAD;             // and request the scratchpad
+  transaction.txLength = 10;
+  transaction.rxLength = 9;
+  return (queue(transaction));
+}  // of method queueReadScratchpad()
+bool DSFamily_Async::queueStartConvert(DSFamily_Transaction &transaction) {
+  /*!
+    @brief     Queue a conversion start for all devices
+    @details   The caller needs to wait for the conversion time before reading the results, in
+               parasitic mode no other transaction may be queued during that time
+    @param[in] transaction Transaction to fill and queue
+    @return    "false" if the transaction couldn't be queued
+  */
+  if (transaction.status == DS_TX_QUEUED || transaction.status == DS_TX_ACTIVE) return (false);
+  transaction.tx[0]    = DS_SKIP_ROM;       // Address all devices
+  transaction.tx[1]    = DS_START_CONVERT;  // and start the conversion
+  transaction.txLength = 2;
+  transaction.rxLength = 0;
+  return (queue(transaction));
+}  // of method queueStartConvert()
+bool DSFamily_Async::busy() {
+  /*!
+    @brief   Check if transactions are still queued or running
+    @return  "true" if the engine is busy
+  */
+  return (_Count != 0);
+}  // of method busy()
+void DSFamily_Async::isr() {
+  /*!
+    @brief   Timer2 compare match handler, performs one step of the current transaction
+    @details Each call handles one edge of a reset or bit slot and then programs the timer for the
+             next step. Only the short sections of a slot which need exact timing (the 10us low
+             pulse of a "1" and the 13us read sample) are done with delayMicroseconds() inside the
+             interrupt; all the long waits are done by the timer
+  */
+#if defined(DS_ASYNC_AVAILABLE)
+  DSFamily_Transaction *t    = _Queue[_Head];  // Current transaction
+  volatile IO_REG_TYPE *reg  = _Bus->baseReg;  // Register of the 1-Wire pin
+  IO_REG_TYPE           mask = _Bus->bitmask;  // Bitmask of the 1-Wire pin
+  uint8_t               v;                     // Bit written or read
+  switch (_Phase) {
+    case DS_PHASE_RESET:
+      DIRECT_WRITE_LOW(reg, mask);
+      DIRECT_MODE_OUTPUT(reg, mask);  // drive output low
+      _Phase = DS_PHASE_RELEASE;
+      schedule(480);
+      break;
+    case DS_PHASE_RELEASE:
+      DIRECT_MODE_INPUT(reg, mask);  // allow it to float
+      _Phase = DS_PHASE_PRESENCE;
+      schedule(70);
+      break;
+    case DS_PHASE_PRESENCE:
+      if (DIRECT_READ(reg, mask)) {
+        finish(DS_TX_NO_PRESENCE);  // Nobody pulled the line low
+      } else {
+        _Phase = DS_PHASE_SLOT;
+        schedule(410);
+      }  // if-then-else presence pulse seen
+      break;
+    case DS_PHASE_SLOT:
+      if (_Bit < t->txLength * 8) {
+        v = (t->tx[_Bit >> 3] >> (_Bit & 7)) & 1;  // Next bit to write
+        _Bit++;
+        DIRECT_WRITE_LOW(reg, mask);
+        DIRECT_MODE_OUTPUT(reg, mask);  // drive output low
+        if (v) {
+          delayMicroseconds(10);         // Short low pulse for a "1"
+          DIRECT_WRITE_HIGH(reg, mask);  // drive output high
+          schedule(55);
+        } else {
+          _Phase = DS_PHASE_WRITE0;  // Release the line later
+          schedule(65);
+        }  // if-then-else write a "1"
+      } else if (_Bit < (t->txLength + t->rxLength) * 8) {
+        uint8_t i = _Bit - t->txLength * 8;  // Bit index in rx
+        _Bit++;
+        DIRECT_MODE_OUTPUT(reg, mask);
+        DIRECT_WRITE_LOW(reg, mask);
+        delayMicroseconds(3);          // Wait
+        DIRECT_MODE_INPUT(reg, mask);  // let pin float, pull up will raise it up again
+        delayMicroseconds(10);         // Wait
+        v = DIRECT_READ(reg, mask);
+        if ((i & 7) == 0) t->rx[i >> 3] = 0;  // Start a new byte
+        if (v) t->rx[i >> 3] |= 1 << (i & 7);
+        v = (_Crc ^ v) & 1;  // Update crc8 one bit at a time
+        _Crc >>= 1;
+        if (v) _Crc ^= 0x8C;
+        schedule(53);
+      } else {
+        finish((t->rxLength == 9 && _Crc != 0) ? DS_TX_CRC_ERROR : DS_TX_DONE);
+      }  // if-then-else write, read or done
+      break;
+    case DS_PHASE_WRITE0:
+      DIRECT_WRITE_HIGH(reg, mask);  // drive output high
+      _Phase = DS_PHASE_SLOT;
+      schedule(5);
+      break;
+  }  // of switch on the phase
+#endif
+}  // of method isr()
+void DSFamily_Async::startNext() {
+  /*!
+    @brief   Start the transaction at the head of the queue, called with interrupts disabled
+  */
+  if (_Count) {
+    _Queue[_Head]->status = DS_TX_ACTIVE;
+    _Active               = true;
+    _Bit                  = 0;
+    _Crc                  = 0;
+    _Phase                = DS_PHASE_RESET;
+    schedule(10);  // Begin with the reset pulse
+  }                // if-then queue isn't empty
+}  // of method startNext()
+void DSFamily_Async::finish(const uint8_t status) {
+  /*!
+    @brief     Complete the current transaction and start the next one
+    @param[in] status Final DSTransactionStatus of the transaction
+  */
+#if defined(DS_ASYNC_AVAILABLE)
+  DSFamily_Transaction *t = _Queue[_Head];
+  TCCR2B                  = 0;                      // Stop the timer
+  TIMSK2 &= ~_BV(OCIE2A);                           // and its interrupt
+  DIRECT_MODE_INPUT(_Bus->baseReg, _Bus->bitmask);  // Let the line float
+  DIRECT_WRITE_LOW(_Bus->baseReg, _Bus->bitmask);
+  t->status = status;
+  _Head     = (_Head + 1) % DS_ASYNC_QUEUE_SIZE;
+  _Count--;
+  _Active = false;
+  if (t->callback) t->callback(t);  // Tell the caller, which may queue the next transaction
+  if (!_Active) startNext();        // and continue with the queue
+#else
+  (void)status;
+#endif
+}  // of method finish()
+void DSFamily_Async::schedule(const uint16_t micros) {
+  /*!
+    @brief     Program Timer2 to call the interrupt again after the given time
+    @param[in] micros Microseconds until the next step
+  */
+#if defined(DS_ASYNC_AVAILABLE)
+  uint16_t ticks = (uint32_t)micros * (F_CPU / 1000000UL) / DS_TIMER_PRESCALE;
+  if (ticks < 2) ticks = 2;  // Timer needs at least one tick
+  TCCR2B = 0;                // Stop the timer while changing it
+  TCNT2  = 0;
+  OCR2A  = ticks - 1;
+  TIFR2  = _BV(OCF2A);  // Clear a pending match
+  TIMSK2 |= _BV(OCIE2A);
+  TCCR2B = DS_TIMER_CLOCK;  // and start it again
+#else
+  (void)micros;
+#endif
+}  // of method schedule()
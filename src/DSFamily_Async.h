@@ -0,0 +1,113 @@
+// clang-format off
+/*! @file DSFamily_Async.h
+
+ @section DSFamily_Async_intro_section Description
+
+Optional interrupt-driven transfer engine for the DSFamily library. The normal DSFamily_Class
+functions bit-bang every 1-Wire slot with delayMicroseconds(), so a single scratchpad read keeps the
+processor busy for about 6ms per device. This engine instead runs the bus from the Timer2
+compare-match interrupt: each interrupt performs one edge of a slot and programs the timer for the
+next one, so interrupts are only disabled for the few microseconds around each edge and the main
+program is free in between.\n\n
+
+Work is submitted as DSFamily_Transaction structures which are placed in a small queue; each one is
+a reset followed by up to 10 bytes written and up to 9 bytes read. Completion is signalled through
+the transaction's "status" member and an optional callback, which is called from interrupt context
+and must be kept short. The callback may queue the next transaction, e.g. to chain a conversion and
+the reads which follow it.\n\n
+
+Since Timer2 is also used by tone() and PWM on pins 3 and 11 (Uno) the engine is opt-in. The
+sketch declares the object and places the DS_ASYNC_TIMER_ISR() macro exactly once:\n
+
+    DSFamily_Class DSFamily(5);
+    DSFamily_Async DSAsync(DSFamily);
+    DS_ASYNC_TIMER_ISR(DSAsync)
+\n
+The synchronous functions of DSFamily_Class must not be used while transactions are queued. The
+engine is available on Atmel processors with a Timer2 (e.g. ATmega328P and ATmega2560); on all other
+platforms begin() returns "false".
+
+@section DSFamily_Async_license GNU General Public License v3.0
+
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU
+General Public License as published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version. This program is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details. You should
+have received a copy of the GNU General Public License along with this program.  If not, see
+<http://www.gnu.org/licenses/>.
+*/
+// clang-format on
+#ifndef DSFamily_Async_h
+  /** @brief  Guard code to prevent multiple definitions */
+  #define DSFamily_Async_h
+  #include "DSFamily.h"  // Include the DSFamily class definition
+  #if defined(__AVR__) && defined(TCCR2A)
+    /** @brief  Timer2 is available for the asynchronous engine */
+    #define DS_ASYNC_AVAILABLE
+    /** @brief  Place exactly once in the sketch to connect Timer2 to the asynchronous engine */
+    #define DS_ASYNC_TIMER_ISR(engine) \
+      ISR(TIMER2_COMPA_vect) { engine.isr(); }
+  #else
+    /** @brief  No Timer2 available, the macro expands to nothing */
+    #define DS_ASYNC_TIMER_ISR(engine)
+  #endif
+  #ifndef DS_ASYNC_QUEUE_SIZE
+    /** @brief  Number of transactions that can be queued */
+    #define DS_ASYNC_QUEUE_SIZE 4
+  #endif
+/*!
+ * @brief   Status values of a DSFamily_Transaction
+ */
+enum DSTransactionStatus : uint8_t {
+  DS_TX_IDLE = 0,     ///< Not queued
+  DS_TX_QUEUED,       ///< Waiting in the queue
+  DS_TX_ACTIVE,       ///< Currently on the bus
+  DS_TX_DONE,         ///< Finished successfully
+  DS_TX_NO_PRESENCE,  ///< No device answered the reset
+  DS_TX_CRC_ERROR     ///< A 9 byte scratchpad read had a bad CRC
+};
+struct DSFamily_Transaction;
+/** @brief  Completion callback, called from interrupt context */
+typedef void (*DSTransactionCallback)(DSFamily_Transaction *transaction);
+/*!
+ * @brief   A single 1-Wire transfer: reset, write txLength bytes, read rxLength bytes
+ */
+struct DSFamily_Transaction {
+  uint8_t               tx[10];                 ///< Bytes to write after the reset
+  uint8_t               rx[9];                  ///< Bytes read from the bus
+  uint8_t               txLength = 0;           ///< Number of bytes in tx
+  uint8_t               rxLength = 0;           ///< Number of bytes to read into rx
+  volatile uint8_t      status   = DS_TX_IDLE;  ///< Current DSTransactionStatus
+  DSTransactionCallback callback = nullptr;     ///< Optional completion callback
+  void                 *userData = nullptr;     ///< Free for use by the callback
+};
+/*!
+ * @class   DSFamily_Async
+ * @brief   Timer interrupt driven 1-Wire transfers for a DSFamily_Class bus
+ */
+class DSFamily_Async {
+ public:
+  DSFamily_Async(DSFamily_Class &bus);
+  bool begin();
+  bool queue(DSFamily_Transaction &transaction);
+  bool queueReadScratchpad(DSFamily_Transaction &transaction, const DSDeviceNumber deviceNumber);
+  bool queueStartConvert(DSFamily_Transaction &transaction);
+  bool busy();
+  void isr();
+
+ private:
+  DSFamily_Class       *_Bus;                         ///< Bus whose pin is used
+  DSFamily_Transaction *_Queue[DS_ASYNC_QUEUE_SIZE];  ///< Circular transaction queue
+  volatile uint8_t      _Head   = 0;                  ///< Next queue entry to run
+  volatile uint8_t      _Count  = 0;                  ///< Number of queued entries
+  volatile bool         _Active = false;              ///< A transaction is on the bus
+  volatile uint8_t      _Phase  = 0;                  ///< Current phase of the transfer
+  uint8_t               _Bit    = 0;                  ///< Bit index in the transaction
+  uint8_t               _Crc    = 0;                  ///< Running crc8 of the bytes read
+
+  void startNext();
+  void finish(const uint8_t status);
+  void schedule(const uint16_t micros);
+};  // of DSFamily_Async class definition
+#endif
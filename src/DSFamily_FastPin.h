@@ -0,0 +1,211 @@
+// clang-format off
+/*! @file DSFamily_FastPin.h
+
+ @section DSFamily_FastPin_intro_section Description
+
+Compile-time pin specialization of the DSFamily_Class. When the 1-Wire pin is known when the
+program is compiled it can be given as a template parameter, e.g. "DSFamily_FastPin<5> DSFamily;"
+instead of "DSFamily_Class DSFamily(5);". On the supported Atmel processors the port register and
+bitmask are then resolved by the compiler so that each edge of a 1-Wire slot is a single "sbi" or
+"cbi" instruction instead of a read-modify-write through a pointer loaded from the class members.
+This tightens the slot timing and removes the register loads from every bit.\n\n
+
+All other functions are inherited from DSFamily_Class. Pins that can't be resolved at compile time
+(ports which aren't in the lower I/O space or unsupported processors) transparently use the
+runtime-pin code of DSFamily_Class, so a program works unchanged on every platform.\n\n
+
+Supported are the ATmega328P/168/88 (Uno, Nano, Pro Mini), ATmega32U4 (Leonardo, Micro) and the
+ATmega2560/1280 (Mega) ports A to G.
+
+@section DSFamily_FastPin_license GNU General Public License v3.0
+
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU
+General Public License as published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version. This program is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details. You should
+have received a copy of the GNU General Public License along with this program.  If not, see
+<http://www.gnu.org/licenses/>.
+*/
+// clang-format on
+#ifndef DSFamily_FastPin_h
+  /** @brief  Guard code to prevent multiple definitions */
+  #define DSFamily_FastPin_h
+  #include "DSFamily.h"  // Include the runtime-pin class definition
+  /** @brief  Encode a port letter and bit number into a single byte of the fast pin map */
+  #define DS_FP(port, bit) ((((port) - 'A') << 3) | (bit))
+  /** @brief  Pin map entry for a pin that can't be accessed with "sbi"/"cbi" */
+  #define DS_NO_FP 0xFF
+  #if defined(__AVR_ATmega328P__) || defined(__AVR_ATmega328__) || defined(__AVR_ATmega168__) || \
+      defined(__AVR_ATmega168P__) || defined(__AVR_ATmega88__) || defined(__AVR_ATmega328PB__)
+/** @brief  Port and bit of each Arduino pin on the ATmega328P family */
+constexpr uint8_t DS_FASTPIN_MAP[] = {
+    DS_FP('D', 0), DS_FP('D', 1), DS_FP('D', 2), DS_FP('D', 3), DS_FP('D', 4),
+    DS_FP('D', 5), DS_FP('D', 6), DS_FP('D', 7), DS_FP('B', 0), DS_FP('B', 1),
+    DS_FP('B', 2), DS_FP('B', 3), DS_FP('B', 4), DS_FP('B', 5), DS_FP('C', 0),
+    DS_FP('C', 1), DS_FP('C', 2), DS_FP('C', 3), DS_FP('C', 4), DS_FP('C', 5)};
+  #elif defined(__AVR_ATmega32U4__)
+/** @brief  Port and bit of each Arduino pin on the ATmega32U4 */
+constexpr uint8_t DS_FASTPIN_MAP[] = {
+    DS_FP('D', 2), DS_FP('D', 3), DS_FP('D', 1), DS_FP('D', 0), DS_FP('D', 4),
+    DS_FP('C', 6), DS_FP('D', 7), DS_FP('E', 6), DS_FP('B', 4), DS_FP('B', 5),
+    DS_FP('B', 6), DS_FP('B', 7), DS_FP('D', 6), DS_FP('C', 7), DS_FP('B', 3),
+    DS_FP('B', 1), DS_FP('B', 2), DS_FP('B', 0), DS_FP('F', 7), DS_FP('F', 6),
+    DS_FP('F', 5), DS_FP('F', 4), DS_FP('F', 1), DS_FP('F', 0)};
+  #elif defined(__AVR_ATmega2560__) || defined(__AVR_ATmega1280__)
+/** @brief  Port and bit of each Arduino pin on the ATmega2560, ports H to L are memory mapped */
+constexpr uint8_t DS_FASTPIN_MAP[] = {
+    DS_FP('E', 0), DS_FP('E', 1), DS_FP('E', 4), DS_FP('E', 5), DS_FP('G', 5),  // 0-4
+    DS_FP('E', 3), DS_NO_FP,      DS_NO_FP,      DS_NO_FP,      DS_NO_FP,       // 5-9
+    DS_FP('B', 4), DS_FP('B', 5), DS_FP('B', 6), DS_FP('B', 7), DS_NO_FP,       // 10-14
+    DS_NO_FP,      DS_NO_FP,      DS_NO_FP,      DS_FP('D', 3), DS_FP('D', 2),  // 15-19
+    DS_FP('D', 1), DS_FP('D', 0), DS_FP('A', 0), DS_FP('A', 1), DS_FP('A', 2),  // 20-24
+    DS_FP('A', 3), DS_FP('A', 4), DS_FP('A', 5), DS_FP('A', 6), DS_FP('A', 7),  // 25-29
+    DS_FP('C', 7), DS_FP('C', 6), DS_FP('C', 5), DS_FP('C', 4), DS_FP('C', 3),  // 30-34
+    DS_FP('C', 2), DS_FP('C', 1), DS_FP('C', 0), DS_FP('D', 7), DS_FP('G', 2),  // 35-39
+    DS_FP('G', 1), DS_FP('G', 0), DS_NO_FP,      DS_NO_FP,      DS_NO_FP,       // 40-44
+    DS_NO_FP,      DS_NO_FP,      DS_NO_FP,      DS_NO_FP,      DS_NO_FP,       // 45-49
+    DS_FP('B', 3), DS_FP('B', 2), DS_FP('B', 1), DS_FP('B', 0), DS_FP('F', 0),  // 50-54
+    DS_FP('F', 1), DS_FP('F', 2), DS_FP('F', 3), DS_FP('F', 4), DS_FP('F', 5),  // 55-59
+    DS_FP('F', 6), DS_FP('F', 7)};                                              // 60-61
+  #else
+/** @brief  No compile-time pin information for this processor */
+constexpr uint8_t DS_FASTPIN_MAP[] = {DS_NO_FP};
+  #endif
+/*!
+ * @brief   Compile-time port register and bitmask for an Arduino pin
+ * @details On all supported processors the PINx, DDRx and PORTx registers of port "A" + n are
+ *          located at I/O addresses 3n, 3n+1 and 3n+2, so the map only needs to store the port
+ *          number and the bit
+ */
+template <uint8_t Pin>
+struct DSFamily_PinTraits {
+  /*! @brief Encoded port and bit of the pin */
+  static constexpr uint8_t code    = Pin < sizeof(DS_FASTPIN_MAP) ? DS_FASTPIN_MAP[Pin] : DS_NO_FP;
+  static constexpr bool    fast    = code != DS_NO_FP;             ///< Pin can use sbi/cbi
+  static constexpr uint8_t pinAddr = fast ? (code >> 3) * 3 : 0;  ///< PINx I/O address
+  static constexpr uint8_t mask    = 1 << (code & 7);             ///< Bitmask within the port
+};
+/*!
+ * @class   DSFamily_FastPin
+ * @brief   DSFamily_Class with the 1-Wire pin resolved at compile time
+ */
+template <uint8_t Pin>
+class DSFamily_FastPin : public DSFamily_Class {
+ public:
+  /*!
+    @brief     Class constructor
+    @param[in] ReserveRom (Optional) Number of bytes of ROM space to reserve
+  */
+  DSFamily_FastPin(const uint8_t ReserveRom = 0) : DSFamily_Class(Pin, ReserveRom) {}
+  #if defined(__AVR__)
+
+ protected:
+  uint8_t reset(void) override;
+  void    write_bit(uint8_t v) override;
+  uint8_t read_bit(void) override;
+  void    depower(void) override;
+
+ private:
+  typedef DSFamily_PinTraits<Pin> T;  ///< Shorthand for the pin information
+  /*! @brief Read the pin state */
+  static inline uint8_t readPin() { return (_SFR_IO8(T::pinAddr) & T::mask) ? 1 : 0; }
+  /*! @brief Make the pin an input */
+  static inline void modeInput() { _SFR_IO8(T::pinAddr + 1) &= ~T::mask; }
+  /*! @brief Make the pin an output */
+  static inline void modeOutput() { _SFR_IO8(T::pinAddr + 1) |= T::mask; }
+  /*! @brief Drive the pin low */
+  static inline void writeLow() { _SFR_IO8(T::pinAddr + 2) &= ~T::mask; }
+  /*! @brief Drive the pin high */
+  static inline void writeHigh() { _SFR_IO8(T::pinAddr + 2) |= T::mask; }
+  #endif
+};  // of DSFamily_FastPin class definition
+  #if defined(__AVR__)
+template <uint8_t Pin>
+uint8_t DSFamily_FastPin<Pin>::reset(void) {
+  /*!
+    @brief      Perform the 1-wire reset function with compile-time pin access
+    @details    See DSFamily_Class::reset() for details
+  */
+  if (!T::fast) return DSFamily_Class::reset();  // Use the runtime pin code
+  uint8_t r;                                     // Return value
+  uint8_t retries = 125;                         // Maximum number of retries
+  noInterrupts();                                // Disable interrupts for now
+  modeInput();                                   // Let the line float
+  interrupts();                                  // Enable interrupts again
+  do                                             // wait until the wire is high...
+  {
+    if (--retries == 0) return 0;  // wire is broken or shorted, so return
+    delayMicroseconds(2);          // Wait a bit
+  } while (!readPin());            // wait until the wire is high...
+  noInterrupts();                  // Disable interrupts for now
+  writeLow();
+  modeOutput();            // drive output low
+  interrupts();            // Enable interrupts again
+  delayMicroseconds(480);  // Wait 480 microseconds
+  noInterrupts();          // Disable interrupts for now
+  modeInput();             // allow it to float
+  delayMicroseconds(70);   // Wait 70 microseconds
+  r = !readPin();          // Read the status
+  interrupts();            // Enable interrupts again
+  delayMicroseconds(410);  // Wait again
+  return r;                // return the result
+}  // of method reset()
+template <uint8_t Pin>
+void DSFamily_FastPin<Pin>::write_bit(uint8_t v) {
+  /*!
+    @brief      Write a bit to 1-wire with compile-time pin access
+    @param[in]  v Only the LSB is used as the bit to write to 1-Wire
+  */
+  if (!T::fast) return DSFamily_Class::write_bit(v);  // Use the runtime pin code
+  if (v & 1)                                          // If writing a "1"
+  {
+    noInterrupts();  // Disable interrupts for now
+    writeLow();
+    modeOutput();           // drive output low
+    delayMicroseconds(10);  // Wait
+    writeHigh();            // drive output high
+    interrupts();           // Enable interrupts again
+    delayMicroseconds(55);  // Wait
+  } else {
+    noInterrupts();  // Disable interrupts for now
+    writeLow();
+    modeOutput();           // drive output low
+    delayMicroseconds(65);  // Wait
+    writeHigh();            // drive output high
+    interrupts();           // Enable interrupts again
+    delayMicroseconds(5);   // Wait
+  }                         // of if-then we have a "true" to write
+}  // of method write_bit()
+template <uint8_t Pin>
+uint8_t DSFamily_FastPin<Pin>::read_bit(void) {
+  /*!
+    @brief      Read a bit from 1-wire with compile-time pin access
+    @return     single bit where only the LSB is used as the bit that was read
+  */
+  if (!T::fast) return DSFamily_Class::read_bit();  // Use the runtime pin code
+  uint8_t r;                                        // Return bit
+  noInterrupts();                                   // Disable interrupts for now
+  modeOutput();
+  writeLow();
+  delayMicroseconds(3);   // Wait
+  modeInput();            // let pin float, pull up will raise it up again
+  delayMicroseconds(10);  // Wait
+  r = readPin();
+  interrupts();           // Enable interrupts again
+  delayMicroseconds(53);  // Wait
+  return r;               // Return result
+}  // of method read_bit()
+template <uint8_t Pin>
+void DSFamily_FastPin<Pin>::depower(void) {
+  /*!
+    @brief      Stop driving the 1-Wire line with compile-time pin access
+  */
+  if (!T::fast) return DSFamily_Class::depower();  // Use the runtime pin code
+  noInterrupts();
+  modeInput();
+  writeLow();
+  interrupts();
+}  // of method depower()
+  #endif
+#endif
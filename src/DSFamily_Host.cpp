@@ -0,0 +1,74 @@
+/*! @file DSFamily_Host.cpp
+ @section DSFamily_Hostcpp_intro_section Description
+
+Arduino API emulation with a virtual clock for native host builds of the DSFamily library\n\n
+See the header file DSFamily_Host.h for details
+*/
+#if !defined(ARDUINO)
+  #include "DSFamily_Host.h"  // Include the header definition
+/***************************************************************************************************
+** Declare constants used in the emulation                                                        **
+***************************************************************************************************/
+const uint32_t DS_HOST_YIELD_MICROS{100};  ///< Virtual time taken by a call to yield()
+
+volatile uint8_t DSHostIORegister{0xFF};  ///< Dummy I/O register, reads as an idle high line
+EEPROMClass      EEPROM;                  ///< The emulated EEPROM, cleared at startup
+static uint64_t  hostMicros{0};           ///< Current virtual time in microseconds
+
+uint32_t millis() {
+  /*!
+    @brief   Virtual time since the start of the program
+    @return  Milliseconds, wrapping around after about 49 days just like on a real device
+  */
+  return ((uint32_t)(hostMicros / 1000));
+}  // of function millis()
+uint32_t micros() {
+  /*!
+    @brief   Virtual time since the start of the program
+    @return  Microseconds, wrapping around after about 71 minutes just like on a real device
+  */
+  return ((uint32_t)hostMicros);
+}  // of function micros()
+void delay(const uint32_t ms) {
+  /*!
+    @brief     Advance the virtual clock
+    @param[in] ms Milliseconds to wait
+  */
+  hostMicros += (uint64_t)ms * 1000;
+}  // of function delay()
+void delayMicroseconds(const uint32_t us) {
+  /*!
+    @brief     Advance the virtual clock
+    @param[in] us Microseconds to wait
+  */
+  hostMicros += us;
+}  // of function delayMicroseconds()
+void yield() {
+  /*!
+    @brief   Advance the virtual clock by the time a pass through a busy-wait loop would take
+    @details Without this a loop waiting for the time to pass would never end on the host
+  */
+  hostMicros += DS_HOST_YIELD_MICROS;
+}  // of function yield()
+uint64_t DSHostMicros() {
+  /*!
+    @brief   Return the full 64-bit virtual time
+    @return  Microseconds since the start of the program
+  */
+  return (hostMicros);
+}  // of function DSHostMicros()
+void DSHostAdvance(const uint32_t us) {
+  /*!
+    @brief     Advance the virtual clock, used by the bus simulation for the length of each slot
+    @param[in] us Microseconds to advance
+  */
+  hostMicros += us;
+}  // of function DSHostAdvance()
+void DSHostSetMicros(const uint64_t us) {
+  /*!
+    @brief     Set the virtual clock, e.g. to test the millis() rollover
+    @param[in] us New virtual time in microseconds
+  */
+  hostMicros = us;
+}  // of function DSHostSetMicros()
+#endif
@@ -0,0 +1,94 @@
+// clang-format off
+/*! @file DSFamily_Host.h
+
+ @section DSFamily_Host_intro_section Description
+
+Minimal emulation of the Arduino API used by the DSFamily library so that the library can be built
+natively on a host computer, e.g. a Linux PC, for unit tests and benchmarks. The header is included
+by DSFamily.h instead of "Arduino.h" and "EEPROM.h" whenever ARDUINO is not defined.\n\n
+
+Time is virtual: millis() and micros() return a counter which only advances through delay(),
+delayMicroseconds(), yield() and DSHostAdvance(). The simulated 1-Wire bus in DSFamily_Sim advances
+the same clock by the duration of each slot, so timings reported by a host build correspond to the
+bus time on a real device and runs are fully deterministic. The EEPROM is emulated in RAM with a
+size of E2END + 1 bytes, which defaults to 4KB and can be changed with "-DE2END=..." on the compiler
+command line.
+
+@section DSFamily_Host_license GNU General Public License v3.0
+
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU
+General Public License as published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version. This program is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details. You should
+have received a copy of the GNU General Public License along with this program.  If not, see
+<http://www.gnu.org/licenses/>.
+*/
+// clang-format on
+#ifndef DSFamily_Host_h
+  /** @brief  Guard code to prevent multiple definitions */
+  #define DSFamily_Host_h
+  #include <math.h>
+  #include <stdint.h>
+  #include <stdlib.h>
+  #include <string.h>
+
+  #include <algorithm>
+  #ifndef E2END
+    /** @brief  Address of the last byte of the emulated EEPROM */
+    #define E2END 4095
+  #endif
+  /** @brief  Pin mode constant */
+  #define INPUT 0x0
+  /** @brief  Pin mode constant */
+  #define OUTPUT 0x1
+  /** @brief  Flash memory attribute, unused on the host */
+  #define PROGMEM
+  /** @brief  Read a byte from flash memory, which is normal memory on the host */
+  #define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+  /** @brief  Square of a value */
+  #define sq(x) ((x) * (x))
+typedef bool boolean;  ///< Arduino boolean type
+using std::max;
+using std::min;
+extern volatile uint8_t DSHostIORegister;  ///< Dummy I/O register used by the pin macros
+
+uint32_t millis();
+uint32_t micros();
+void     delay(const uint32_t ms);
+void     delayMicroseconds(const uint32_t us);
+void     yield();
+uint64_t DSHostMicros();
+void     DSHostAdvance(const uint32_t us);
+void     DSHostSetMicros(const uint64_t us);
+inline void pinMode(const uint8_t, const uint8_t) {}
+inline void noInterrupts() {}
+inline void interrupts() {}
+/*!
+ * @class   EEPROMClass
+ * @brief   RAM based emulation of the Arduino EEPROM library
+ */
+class EEPROMClass {
+ public:
+  uint8_t read(const int address) { return (_Data[address]); }
+  void    write(const int address, const uint8_t value) { _Data[address] = value; }
+  void    update(const int address, const uint8_t value) {
+    if (_Data[address] != value) _Data[address] = value;
+  }
+  template <typename T>
+  T &get(const int address, T &value) {
+    memcpy(&value, &_Data[address], sizeof(T));
+    return (value);
+  }
+  template <typename T>
+  const T &put(const int address, const T &value) {
+    memcpy(&_Data[address], &value, sizeof(T));
+    return (value);
+  }
+  uint16_t length() { return (E2END + 1); }
+
+ private:
+  uint8_t _Data[E2END + 1];  ///< Emulated EEPROM contents
+};                           // of EEPROMClass definition
+extern EEPROMClass EEPROM;   ///< The emulated EEPROM instance
+#endif
@@ -0,0 +1,372 @@
+/*! @file DSFamily_MultiBus.cpp
+ @section DSFamily_MultiBuscpp_intro_section Description
+
+Lockstep driver for several 1-Wire buses of the DSFamily library\n\n
+See the header file DSFamily_MultiBus.h for details
+*/
+#include "DSFamily_MultiBus.h"  // Include the header definition
+DSFamily_MultiBus::DSFamily_MultiBus(DSFamily_Class *const buses[], const uint8_t busCount)
+    : _BusCount(min(busCount, (uint8_t)DS_MULTIBUS_MAX_BUSES)) {
+  /*!
+    @brief     Class constructor
+    @param[in] buses Array of the DSFamily_Class instances to drive, the array itself isn't kept
+    @param[in] busCount Number of entries in buses, at most DS_MULTIBUS_MAX_BUSES are used
+  */
+  for (uint8_t k = 0; k < _BusCount; k++) _Bus[k] = buses[k];
+  _AllBuses = (uint8_t)((1 << _BusCount) - 1);  // Bit n set for bus n
+}  // of class constructor
+bool DSFamily_MultiBus::begin(const DSDeviceNumber devicesPerBus) {
+  /*!
+    @brief     Assign the EEPROM regions and check if the buses can be driven in lockstep
+    @details   The EEPROM space above the largest ReserveRom constructor parameter of the buses is
+               divided into one ROM table region per bus. The regions only depend on the buses and
+               devicesPerBus, so calling begin() again lays out the same ones. Call it before
+               ScanForDevices()
+    @param[in] devicesPerBus (Optional) Number of devices per bus to reserve room for, by default
+               the available space is divided evenly
+    @return    "true" if all pins are on the same port and the buses run in lockstep, "false" if
+               they are driven one after the other
+  */
+  if (_BusCount == 0) return (false);
+  uint8_t reserve = 0;  // Bytes none of the buses may use
+  for (uint8_t k = 0; k < _BusCount; k++) reserve = max(reserve, _Bus[k]->_ReserveRom);
+  uint16_t space   = (E2END + 1 - reserve) / _BusCount;  // Even share of each bus
+  uint16_t devices = 0;                                  // Entries in each region
+  if (space > DS_TABLE_HEADER_SIZE) devices = (space - DS_TABLE_HEADER_SIZE) / DS_ROM_ENTRY_SIZE;
+  if (devices > DS_MAX_DEVICES) devices = DS_MAX_DEVICES;
+  if (devicesPerBus && devicesPerBus < devices) devices = devicesPerBus;
+  for (uint8_t k = 0; k < _BusCount; k++) {
+    _Bus[k]->SetRomRegion(
+        E2END + 1 - k * (DS_TABLE_HEADER_SIZE + devices * DS_ROM_ENTRY_SIZE), devices);
+  }  // for-next each bus
+  _Lockstep = false;
+#if defined(DS_MULTIBUS_LOCKSTEP)
+  IO_REG_TYPE used = 0;  // Port bits of the buses so far
+  _BaseReg         = _Bus[0]->baseReg;
+  _Lockstep        = true;
+  for (uint8_t k = 0; k < _BusCount; k++) {
+    _PortMask[k] = _Bus[k]->bitmask;
+    if (_Bus[k]->baseReg != _BaseReg || (used & _PortMask[k])) _Lockstep = false;
+    used |= _PortMask[k];
+  }  // for-next each bus
+#endif
+  return (_Lockstep);
+}  // of method begin()
+uint16_t DSFamily_MultiBus::ScanForDevices(const bool warmStart) {
+  /*!
+    @brief     Search each bus for devices and store them in the bus's own ROM table
+    @details   The search takes a different path on every bus, so the buses are searched one after
+               the other using DSFamily_Class::ScanForDevices()
+    @param[in] warmStart (Optional) Try the stored tables before searching the buses
+    @return    Number of devices found on all buses
+  */
+  uint16_t found = 0;
+  for (uint8_t k = 0; k < _BusCount; k++) found += _Bus[k]->ScanForDevices(warmStart);
+  return (found);
+}  // of method ScanForDevices()
+void DSFamily_MultiBus::DeviceStartConvert(const bool WaitSwitch) {
+  /*!
+    @brief     Start the conversion on all devices of all buses at the same time
+    @param[in] WaitSwitch (Optional, default "false"). When "true" the call doesn't return until
+               measurements have completed
+  */
+  ParasiticWait(_AllBuses);                 // Wait for parasitic conversions to complete
+  reset(_AllBuses);                         // Reset all 1-wire networks
+  write_byte(_AllBuses, DS_SKIP_ROM);       // Tell all devices to listen
+  write_byte(_AllBuses, DS_START_CONVERT);  // Initiate temperature conversion
+  for (uint8_t k = 0; k < _BusCount; k++) _Bus[k]->ConversionStarted(DS_ALL_DEVICES);
+  if (WaitSwitch) {
+    while (poll() == DS_CONVERSION_ACTIVE) yield();  // Don't return until finished
+  }                                                  // if-then wait for the conversion
+}  // of method DeviceStartConvert()
+uint8_t DSFamily_MultiBus::poll() {
+  /*!
+    @brief     Non-blocking check on the conversions of all buses
+    @details   See DSFamily_Class::poll()
+    @return    DS_CONVERSION_ACTIVE while any bus is still converting, otherwise
+               DS_CONVERSION_TIMEOUT if any bus timed out, DS_CONVERSION_DONE or DS_CONVERSION_IDLE
+  */
+  uint8_t result = DS_CONVERSION_IDLE;
+  for (uint8_t k = 0; k < _BusCount; k++) {
+    uint8_t state = _Bus[k]->poll();
+    if (state == DS_CONVERSION_ACTIVE || result == DS_CONVERSION_ACTIVE) {
+      result = DS_CONVERSION_ACTIVE;
+    } else if (state > result) {
+      result = state;  // Timeout takes precedence over done
+    }                  // if-then-else bus is still converting
+  }                    // for-next each bus
+  return (result);
+}  // of method poll()
+uint16_t DSFamily_MultiBus::TakeSnapshot() {
+  /*!
+    @brief     Read every device of every bus once and store the readings in the bus snapshots
+    @details   Device n of all buses is selected and read in the same slots, so a sweep takes as
+               long as the sweep of the bus with the most devices. Buses whose read had a bad CRC
+               are read again while the others stay idle, within the retry budget and quarantine
+               rules of each bus (see DSFamily_Class::SetRetryBudget()). The readings and their
+               statistics, the time of the sweep and the valid flag are stored in each bus just as
+               by DSFamily_Class::TakeSnapshot()
+    @return    Number of devices successfully read on all buses
+  */
+  uint16_t       goodReadings = 0;
+  DSDeviceNumber devices      = 0;  // Most devices in any of the snapshots
+  uint8_t buses, pending, v[DS_MULTIBUS_MAX_BUSES], scratchpad[DS_MULTIBUS_MAX_BUSES][9];
+  uint8_t attempts[DS_MULTIBUS_MAX_BUSES];  // Reads allowed for the device on each bus
+  uint8_t crc[DS_MULTIBUS_MAX_BUSES];       // CRC of the scratchpad bytes read on each bus
+  for (uint8_t k = 0; k < _BusCount; k++) {
+    devices = max(devices, _Bus[k]->ThermometersFound);
+    _Bus[k]->_SnapshotStats.clear();                      // Start the statistics over
+    _Bus[k]->_SweepRetriesLeft = _Bus[k]->_SweepRetries;  // and the retry budget of the sweep
+  }                                                       // for-next each bus
+  for (DSDeviceNumber i = 0; i < devices; i++) {
+    buses   = 0;  // Buses with device i, cleared when it is read
+    pending = 0;  // Buses where device i is still to be read
+    for (uint8_t k = 0; k < _BusCount; k++) {
+      DSFamily_Class *bus = _Bus[k];
+      if (i < bus->ThermometersFound) {
+        buses |= 1 << k;
+        attempts[k] = bus->ReadAttempts(i);
+        if (attempts[k] == 0) continue;  // Removed or quarantined
+        pending |= 1 << k;
+        while (bus->DeviceConverting(i)) yield();  // Wait for this device's conversion
+        bus->ReadRomEntry(i, bus->ROM_NO);         // Address is also used by ScratchpadTemp()
+        bus->_LastCommandWasConvert = false;
+      }  // if-then bus has this device
+    }    // for-next each bus
+    ParasiticWait(pending);
+    for (uint8_t attempt = 0; pending; attempt++) {
+      reset(pending);                      // Reset 1-wire communications
+      write_byte(pending, DS_SELECT_ROM);  // and select device i on each bus
+      for (uint8_t j = 0; j < 8; j++) {
+        for (uint8_t k = 0; k < _BusCount; k++) v[k] = _Bus[k]->ROM_NO[j];
+        write_bytes(pending, v);
+      }                                         // for-next each ROM byte
+      write_byte(pending, DS_READ_SCRATCHPAD);  // Request the Scratchpad contents
+      memset(crc, 0, sizeof(crc));
+      for (uint8_t j = 0; j < 9; j++) {
+        read_bytes(pending, v);
+        for (uint8_t k = 0; k < _BusCount; k++) {
+          scratchpad[k][j] = v[k];
+          crc[k]           = DSFamily_Class::crc8Update(crc[k], v[k]);  // Checked as it arrives
+        }  // for-next each bus
+      }    // for-next each scratchpad byte
+      for (uint8_t k = 0; k < _BusCount; k++) {
+        if (!((pending >> k) & 1)) continue;
+        if (crc[k] == 0) {  // 0 over data and CRC byte if valid
+          _Bus[k]->SnapshotReading(i, _Bus[k]->ScratchpadTemp(i, scratchpad[k], false));
+          _Bus[k]->ReadFinished(i, true, attempt);
+          pending &= ~(1 << k);  // Done with this bus
+          buses &= ~(1 << k);
+          goodReadings++;
+        } else if (attempt + 1 >= attempts[k]) {
+          _Bus[k]->ReadFinished(i, false, attempt);
+          pending &= ~(1 << k);  // Budget used up
+        }                        // if-then-else valid reading
+      }                          // for-next each bus
+    }                            // for-next each attempt
+    for (uint8_t k = 0; k < _BusCount; k++) {
+      if ((buses >> k) & 1) _Bus[k]->SnapshotReading(i, DS_BAD_TEMPERATURE);
+    }  // for-next each bus which couldn't be read
+  }    // for-next each device number
+  for (uint8_t k = 0; k < _BusCount; k++) {
+    _Bus[k]->SnapshotMillis    = millis();   // Store the time of the sweep
+    _Bus[k]->SnapshotValid     = true;       // Readings are current
+    _Bus[k]->_SweepRetriesLeft = UINT8_MAX;  // Single reads aren't limited
+  }                                          // for-next each bus
+  return (goodReadings);
+}  // of method TakeSnapshot()
+void DSFamily_MultiBus::ParasiticWait(const uint8_t buses) {
+  /*!
+    @brief     Wait until parasitically powered devices on the buses have finished converting
+    @param[in] buses Set of buses, bit n for bus n
+  */
+  for (uint8_t k = 0; k < _BusCount; k++) {
+    if ((buses >> k) & 1) _Bus[k]->ParasiticWait();
+  }  // for-next each bus
+}  // of method ParasiticWait()
+IO_REG_TYPE DSFamily_MultiBus::PortMask(const uint8_t buses) {
+  /*!
+    @brief     Return the port bits of a set of buses
+    @param[in] buses Set of buses, bit n for bus n
+    @return    Bitmask of the pins on the shared port
+  */
+  IO_REG_TYPE mask = 0;
+  for (uint8_t k = 0; k < _BusCount; k++) {
+    if ((buses >> k) & 1) mask |= _PortMask[k];
+  }  // for-next each bus
+  return (mask);
+}  // of method PortMask()
+uint8_t DSFamily_MultiBus::BusSet(const IO_REG_TYPE port) {
+  /*!
+    @brief     Return the set of buses whose pins are set in a port value
+    @param[in] port Value read from the shared port
+    @return    Set of buses, bit n for bus n
+  */
+  uint8_t buses = 0;
+  for (uint8_t k = 0; k < _BusCount; k++) {
+    if (port & _PortMask[k]) buses |= 1 << k;
+  }  // for-next each bus
+  return (buses);
+}  // of method BusSet()
+uint8_t DSFamily_MultiBus::reset(const uint8_t buses) {
+  /*!
+    @brief     Perform the 1-wire reset function on a set of buses
+    @details   In lockstep all lines are pulled low with a single port write. Lines which haven't
+               come high after 250us are broken or shorted and are left out of the reset
+    @param[in] buses Set of buses, bit n for bus n
+    @return    Set of buses on which a device asserted a presence pulse
+  */
+  uint8_t present = 0;  // Return value
+#if defined(DS_MULTIBUS_LOCKSTEP)
+  if (_Lockstep) {
+    IO_REG_TYPE               mask       = PortMask(buses);  // Pins of the buses
+    volatile IO_REG_TYPE *reg IO_REG_ASM = _BaseReg;         // point to the base register
+    IO_REG_TYPE               high;                          // Pins which are high
+    uint8_t                   retries = 125;                 // Maximum number of retries
+    noInterrupts();                                          // Disable interrupts for now
+    DIRECT_MODE_INPUT(reg, mask);                            // Let the lines float
+    interrupts();                                            // Enable interrupts again
+    do                                                       // wait until the wires are high...
+    {
+      high = DIRECT_READ_PORT(reg) & mask;
+      if (high == mask) break;  // All lines are high
+      delayMicroseconds(2);     // Wait a bit
+    } while (--retries);
+    noInterrupts();  // Disable interrupts for now
+    DIRECT_WRITE_LOW(reg, high);
+    DIRECT_MODE_OUTPUT(reg, high);                    // drive outputs low
+    interrupts();                                     // Enable interrupts again
+    delayMicroseconds(480);                           // Wait 480 microseconds
+    noInterrupts();                                   // Disable interrupts for now
+    DIRECT_MODE_INPUT(reg, high);                     // allow them to float
+    delayMicroseconds(70);                            // Wait 70 microseconds
+    high &= ~DIRECT_READ_PORT(reg);                   // Lines held low by a presence pulse
+    interrupts();                                     // Enable interrupts again
+    delayMicroseconds(410);                           // Wait again
+    return (BusSet(high));                            // return the result
+  }                                                   // if-then lockstep
+#endif
+  for (uint8_t k = 0; k < _BusCount; k++) {
+    if ((buses >> k) & 1 && _Bus[k]->bus_reset()) present |= 1 << k;
+  }  // for-next each bus
+  return (present);
+}  // of method reset()
+void DSFamily_MultiBus::write_bits(const uint8_t buses, const uint8_t ones) {
+  /*!
+    @brief     Write one bit to each of a set of buses
+    @details   In lockstep all lines are pulled low together, the lines writing a "1" are released
+               after 10us and the ones writing a "0" after 65us, so interrupts stay disabled for
+               the length of a "0" slot
+    @param[in] buses Set of buses, bit n for bus n
+    @param[in] ones Set of buses to which a "1" is written, all others get a "0"
+  */
+#if defined(DS_MULTIBUS_LOCKSTEP)
+  if (_Lockstep) {
+    IO_REG_TYPE               mask       = PortMask(buses);         // Pins of the buses
+    IO_REG_TYPE               one        = PortMask(buses & ones);  // Pins writing a "1"
+    volatile IO_REG_TYPE *reg IO_REG_ASM = _BaseReg;                // Register
+    noInterrupts();                                                 // Disable interrupts for now
+    DIRECT_WRITE_LOW(reg, mask);
+    DIRECT_MODE_OUTPUT(reg, mask);  // drive outputs low
+    delayMicroseconds(10);          // Wait
+    DIRECT_WRITE_HIGH(reg, one);    // drive the "1" outputs high
+    delayMicroseconds(55);          // Wait
+    DIRECT_WRITE_HIGH(reg, mask);   // and then the "0" outputs
+    interrupts();                   // Enable interrupts again
+    delayMicroseconds(5);           // Wait
+    return;
+  }  // if-then lockstep
+#endif
+  for (uint8_t k = 0; k < _BusCount; k++) {
+    if ((buses >> k) & 1) _Bus[k]->bus_write_bit((ones >> k) & 1);
+  }  // for-next each bus
+}  // of method write_bits()
+uint8_t DSFamily_MultiBus::read_bits(const uint8_t buses) {
+  /*!
+    @brief     Read one bit from each of a set of buses
+    @details   In lockstep a single read of the port samples all buses
+    @param[in] buses Set of buses, bit n for bus n
+    @return    Set of buses which returned a "1"
+  */
+  uint8_t r = 0;  // Return bits
+#if defined(DS_MULTIBUS_LOCKSTEP)
+  if (_Lockstep) {
+    IO_REG_TYPE               mask       = PortMask(buses);  // Pins of the buses
+    volatile IO_REG_TYPE *reg IO_REG_ASM = _BaseReg;         // Register
+    IO_REG_TYPE               port;                          // Sampled port value
+    noInterrupts();                                          // Disable interrupts for now
+    DIRECT_MODE_OUTPUT(reg, mask);
+    DIRECT_WRITE_LOW(reg, mask);
+    delayMicroseconds(3);          // Wait
+    DIRECT_MODE_INPUT(reg, mask);  // let pins float, pull ups will raise them up again
+    delayMicroseconds(10);         // Wait
+    port = DIRECT_READ_PORT(reg);
+    interrupts();                  // Enable interrupts again
+    delayMicroseconds(53);         // Wait
+    return (BusSet(port & mask));  // Return result
+  }                                // if-then lockstep
+#endif
+  for (uint8_t k = 0; k < _BusCount; k++) {
+    if ((buses >> k) & 1 && _Bus[k]->bus_read_bit()) r |= 1 << k;
+  }  // for-next each bus
+  return (r);
+}  // of method read_bits()
+void DSFamily_MultiBus::depower(const uint8_t buses) {
+  /*!
+    @brief     Stop driving the lines of a set of buses
+    @param[in] buses Set of buses, bit n for bus n
+  */
+#if defined(DS_MULTIBUS_LOCKSTEP)
+  if (_Lockstep) {
+    IO_REG_TYPE mask = PortMask(buses);
+    noInterrupts();
+    DIRECT_MODE_INPUT(_BaseReg, mask);
+    DIRECT_WRITE_LOW(_BaseReg, mask);
+    interrupts();
+    return;
+  }  // if-then lockstep
+#endif
+  for (uint8_t k = 0; k < _BusCount; k++) {
+    if ((buses >> k) & 1) _Bus[k]->depower();
+  }  // for-next each bus
+}  // of method depower()
+void DSFamily_MultiBus::write_byte(const uint8_t buses, const uint8_t v) {
+  /*!
+    @brief     Write the same byte to a set of buses and let the lines float afterwards
+    @param[in] buses Set of buses, bit n for bus n
+    @param[in] v Byte to write
+  */
+  for (uint8_t bitMask = 0x01; bitMask; bitMask <<= 1) {
+    write_bits(buses, (bitMask & v) ? buses : 0);  // Write bits until empty
+  }                                                // for-next each bit
+  depower(buses);
+}  // of method write_byte()
+void DSFamily_MultiBus::write_bytes(const uint8_t buses, const uint8_t v[DS_MULTIBUS_MAX_BUSES]) {
+  /*!
+    @brief     Write a different byte to each of a set of buses and let the lines float afterwards
+    @param[in] buses Set of buses, bit n for bus n
+    @param[in] v Byte to write to each bus, indexed by bus number
+  */
+  for (uint8_t bitMask = 0x01; bitMask; bitMask <<= 1) {
+    uint8_t ones = 0;  // Buses getting a "1"
+    for (uint8_t k = 0; k < _BusCount; k++) {
+      if (v[k] & bitMask) ones |= 1 << k;
+    }  // for-next each bus
+    write_bits(buses, ones);
+  }  // for-next each bit
+  depower(buses);
+}  // of method write_bytes()
+void DSFamily_MultiBus::read_bytes(const uint8_t buses, uint8_t v[DS_MULTIBUS_MAX_BUSES]) {
+  /*!
+    @brief      Read a byte from each of a set of buses
+    @param[in]  buses Set of buses, bit n for bus n
+    @param[out] v Byte read from each bus, indexed by bus number
+  */
+  memset(v, 0, DS_MULTIBUS_MAX_BUSES);
+  for (uint8_t bitMask = 0x01; bitMask; bitMask <<= 1) {
+    uint8_t r = read_bits(buses);  // One bit from every bus
+    for (uint8_t k = 0; k < _BusCount; k++) {
+      if ((r >> k) & 1) v[k] |= bitMask;
+    }  // for-next each bus
+  }    // for-next each bit
+}  // of method read_bytes()
@@ -0,0 +1,84 @@
+// clang-format off
+/*! @file DSFamily_MultiBus.h
+
+ @section DSFamily_MultiBus_intro_section Description
+
+Lockstep driver for several 1-Wire buses of the DSFamily library. Long cable runs are often split
+into separate segments to keep the capacitance of each one low, but every DSFamily_Class instance
+bit-bangs its own pin, so sweeping N buses takes N times as long as sweeping one. When the pins of
+up to 8 buses are on the same port register this class drives them all at once: each edge of a
+slot is a single write to the port, every read slot samples all of the buses with one read of the
+port, and the bits written to each bus can differ within the same slot. Resets, device selects,
+conversion starts and scratchpad reads on N buses therefore take about as long as on a single bus.
+\n\n
+
+Each bus remains a normal DSFamily_Class instance, which is passed to the constructor and can be
+used on its own at any time. begin() gives each bus its own region of the EEPROM for the ROM table,
+since by default all instances store their table at the same address. ScanForDevices() searches
+the buses one after the other as the search paths differ, DeviceStartConvert() and TakeSnapshot()
+run in lockstep. TakeSnapshot() reads device n of every bus in the same slots and stores the
+readings in the snapshot of each bus, so the readings are then accessed through the functions of the
+bus instances, e.g. "bus2.SnapshotTemp(3)" or "bus2.MaxTemperature()".\n\n
+
+    DSFamily_Class    bus1(4), bus2(5), bus3(6);
+    DSFamily_Class   *buses[] = {&bus1, &bus2, &bus3};
+    DSFamily_MultiBus DSMulti(buses, 3);
+\n
+If the pins are on different ports, or on platforms where a port can't be accessed as a whole
+(Teensy 3 and host builds), the same functions work by driving the buses one after the other
+through their own slot primitives.
+
+@section DSFamily_MultiBus_license GNU General Public License v3.0
+
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU
+General Public License as published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version. This program is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details. You should
+have received a copy of the GNU General Public License along with this program.  If not, see
+<http://www.gnu.org/licenses/>.
+*/
+// clang-format on
+#ifndef DSFamily_MultiBus_h
+  /** @brief  Guard code to prevent multiple definitions */
+  #define DSFamily_MultiBus_h
+  #include "DSFamily.h"  // Include the DSFamily class definition
+  #if defined(ARDUINO) && !defined(__MK20DX128__)
+    /** @brief  The port registers can be read and written as a whole */
+    #define DS_MULTIBUS_LOCKSTEP
+  #endif
+  /** @brief  Maximum number of buses, sets of buses are held as bits of a uint8_t */
+  #define DS_MULTIBUS_MAX_BUSES 8
+/*!
+ * @class   DSFamily_MultiBus
+ * @brief   Drive several DSFamily_Class buses on the same port in lockstep
+ */
+class DSFamily_MultiBus {
+ public:
+  DSFamily_MultiBus(DSFamily_Class *const buses[], const uint8_t busCount);
+  bool     begin(const DSDeviceNumber devicesPerBus = 0);
+  uint16_t ScanForDevices(const bool warmStart = false);
+  void     DeviceStartConvert(const bool WaitSwitch = false);
+  uint8_t  poll();
+  uint16_t TakeSnapshot();
+
+ private:
+  DSFamily_Class       *_Bus[DS_MULTIBUS_MAX_BUSES];       ///< The buses being driven
+  uint8_t               _BusCount;                         ///< Number of buses
+  uint8_t               _AllBuses;                         ///< Set with every bus
+  bool                  _Lockstep = false;                 ///< All pins share one port
+  volatile IO_REG_TYPE *_BaseReg  = nullptr;               ///< Base register of the shared port
+  IO_REG_TYPE           _PortMask[DS_MULTIBUS_MAX_BUSES];  ///< Port bit of each bus
+
+  IO_REG_TYPE PortMask(const uint8_t buses);
+  uint8_t     BusSet(const IO_REG_TYPE port);
+  void        ParasiticWait(const uint8_t buses);
+  uint8_t     reset(const uint8_t buses);
+  void        write_bits(const uint8_t buses, const uint8_t ones);
+  uint8_t     read_bits(const uint8_t buses);
+  void        depower(const uint8_t buses);
+  void        write_byte(const uint8_t buses, const uint8_t v);
+  void        write_bytes(const uint8_t buses, const uint8_t v[DS_MULTIBUS_MAX_BUSES]);
+  void        read_bytes(const uint8_t buses, uint8_t v[DS_MULTIBUS_MAX_BUSES]);
+};  // of DSFamily_MultiBus class definition
+#endif
@@ -0,0 +1,373 @@
+/*! @file DSFamily_Sim.cpp
+ @section DSFamily_Simcpp_intro_section Description
+
+Simulated 1-Wire network for native host builds of the DSFamily library\n\n
+See the header file DSFamily_Sim.h for details
+*/
+#if !defined(ARDUINO)
+  #include "DSFamily_Sim.h"  // Include the header definition
+/***************************************************************************************************
+** Declare constants used in the class, but ones that are not visible as public or private class  **
+** components                                                                                     **
+***************************************************************************************************/
+const uint8_t  SIM_DS18S20_FAMILY{0x10};     ///< The family byte for DS18S20
+const uint32_t SIM_RESET_MICROS{960};        ///< Duration of a reset and presence sequence
+const uint32_t SIM_WRITE_MICROS{70};         ///< Duration of a write slot
+const uint32_t SIM_READ_MICROS{66};          ///< Duration of a read slot
+const uint32_t SIM_CONVERSION_MICROS{93750};  ///< Duration of a 9-bit conversion
+const uint8_t  SIM_IDLE{0};                  ///< Device is waiting for a reset
+const uint8_t  SIM_ROM_COMMAND{1};           ///< Receiving the ROM command
+const uint8_t  SIM_MATCH{2};                 ///< Receiving a ROM address to match
+const uint8_t  SIM_SEARCH{3};                ///< Taking part in a search
+const uint8_t  SIM_READ_ROM{4};              ///< Sending the ROM address
+const uint8_t  SIM_FUNCTION{5};              ///< Receiving the function command
+const uint8_t  SIM_READ_SCRATCHPAD{6};       ///< Sending the scratchpad
+const uint8_t  SIM_WRITE_SCRATCHPAD{7};      ///< Receiving TH, TL and configuration
+const uint8_t  SIM_READ_POWER{8};            ///< Sending the power supply mode
+const uint8_t  SIM_CONVERTING{9};            ///< Sending the conversion status
+const uint8_t  SIM_NV_BUSY{10};              ///< Sending the copy or recall status
+
+DSFamily_Sim::DSFamily_Sim(const uint8_t ReserveRom) : DSFamily_Class(0, ReserveRom) {
+  /*!
+    @brief     Class constructor
+    @details   The bus starts out empty, devices are attached with addDevice()
+    @param[in] ReserveRom (Optional) Number of bytes of emulated EEPROM space to reserve
+  */
+}  // of class constructor
+uint16_t DSFamily_Sim::addDevice(const uint8_t family, const uint32_t serial,
+                                 const bool parasitic) {
+  /*!
+    @brief     Attach a new device to the simulated bus
+    @details   The device powers up with the 85°C power-on value in the scratchpad, TH=75, TL=70
+               and 12 bit resolution, just like a factory-new device
+    @param[in] family    Family byte of the ROM address, e.g. 0x28 for a DS18B20
+    @param[in] serial    Serial number which is stored in the lower 4 bytes of the 48-bit serial
+    @param[in] parasitic (Optional) Device is parasitically powered
+    @return    Index of the new device, used in the other functions
+  */
+  DSFamily_SimDevice d;
+  memset(&d, 0, sizeof(d));
+  d.rom[0] = family;
+  for (uint8_t i = 0; i < 4; i++) d.rom[i + 1] = serial >> (i * 8);  // Little-endian serial
+  d.rom[7]        = crc8(d.rom, 7);                                  // Add the ROM CRC
+  d.nv[0]         = 75;                                              // Default TH
+  d.nv[1]         = 70;                                              // Default TL
+  d.nv[2]         = family == SIM_DS18S20_FAMILY ? 0xFF : 0x7F;      // 12 bit resolution
+  d.present       = true;
+  d.parasitic     = parasitic;
+  d.temperature   = 85 * 16;  // Power-on value
+  d.scratchpad[2] = d.nv[0];
+  d.scratchpad[3] = d.nv[1];
+  d.scratchpad[4] = d.nv[2];
+  d.scratchpad[5] = 0xFF;  // Reserved
+  d.scratchpad[7] = 0x10;  // Reserved on DS18B20, COUNT_PER_C on DS18S20
+  latchTemperature(d);     // Power-on value in the scratchpad
+  d.temperature = 25 * 16;  // Default temperature for the first conversion
+  _Devices.push_back(d);
+  return (_Devices.size() - 1);
+}  // of method addDevice()
+void DSFamily_Sim::setTemperature(const uint16_t index, const int16_t temperature) {
+  /*!
+    @brief     Set the temperature which the next conversion of a device will return
+    @param[in] index       Device index returned by addDevice()
+    @param[in] temperature Temperature in 1/16°C
+  */
+  _Devices[index].temperature = temperature;
+}  // of method setTemperature()
+void DSFamily_Sim::setPresent(const uint16_t index, const bool present) {
+  /*!
+    @brief     Attach or detach a device, a detached device keeps its state
+    @param[in] index   Device index returned by addDevice()
+    @param[in] present "false" to remove the device from the bus
+  */
+  _Devices[index].present = present;
+  _Devices[index].state   = SIM_IDLE;
+}  // of method setPresent()
+void DSFamily_Sim::setCrcErrors(const uint16_t index, const uint8_t count) {
+  /*!
+    @brief     Corrupt the CRC of the next scratchpad reads of a device
+    @param[in] index Device index returned by addDevice()
+    @param[in] count Number of scratchpad reads to corrupt
+  */
+  _Devices[index].crcErrors = count;
+}  // of method setCrcErrors()
+void DSFamily_Sim::setStuckBusy(const uint16_t index, const bool stuck) {
+  /*!
+    @brief     Make the conversions of a device never finish
+    @param[in] index Device index returned by addDevice()
+    @param[in] stuck "true" to never finish, "false" to finish the next conversion normally
+  */
+  _Devices[index].stuckBusy = stuck;
+}  // of method setStuckBusy()
+void DSFamily_Sim::setBusShort(const bool shorted) {
+  /*!
+    @brief     Short the 1-Wire line to ground, no device answers and all reads return "0"
+    @param[in] shorted "true" to short the line
+  */
+  _BusShort = shorted;
+}  // of method setBusShort()
+DSFamily_SimDevice &DSFamily_Sim::device(const uint16_t index) {
+  /*!
+    @brief     Direct access to the state of a simulated device
+    @param[in] index Device index returned by addDevice()
+    @return    Reference to the device state
+  */
+  return (_Devices[index]);
+}  // of method device()
+uint16_t DSFamily_Sim::deviceCount() {
+  /*!
+    @brief   Return the number of simulated devices, including detached ones
+    @return  Number of devices
+  */
+  return (_Devices.size());
+}  // of method deviceCount()
+uint8_t DSFamily_Sim::reset(void) {
+  /*!
+    @brief   Simulate the 1-wire reset function
+    @details All attached devices answer with a presence pulse and wait for a ROM command
+    @return  1 if at least one device answered, otherwise 0
+  */
+  DSHostAdvance(SIM_RESET_MICROS);
+  if (_BusShort) return (0);  // A shorted bus never returns high
+  uint8_t presence = 0;
+  for (DSFamily_SimDevice &d : _Devices) {
+    busActivity(d);
+    d.state = d.present ? SIM_ROM_COMMAND : SIM_IDLE;
+    d.bitCount = 0;
+    d.shift    = 0;
+    if (d.present) presence = 1;
+  }  // for-next each device
+  return (presence);
+}  // of method reset()
+void DSFamily_Sim::write_bit(uint8_t v) {
+  /*!
+    @brief      Simulate a write slot, which is seen by all attached devices
+    @param[in]  v Only the LSB is used as the bit to write to 1-Wire
+  */
+  DSHostAdvance(SIM_WRITE_MICROS);
+  if (_BusShort) return;
+  for (DSFamily_SimDevice &d : _Devices) {
+    busActivity(d);
+    if (d.present) writeSlot(d, v & 1);
+  }  // for-next each device
+}  // of method write_bit()
+uint8_t DSFamily_Sim::read_bit(void) {
+  /*!
+    @brief      Simulate a read slot
+    @details    Any device sending a "0" pulls the line low, so the result is the AND of the bits
+                sent by all attached devices
+    @return     single bit where only the LSB is used as the bit that was read
+  */
+  DSHostAdvance(SIM_READ_MICROS);
+  if (_BusShort) return (0);
+  uint8_t r = 1;
+  for (DSFamily_SimDevice &d : _Devices) {
+    busActivity(d);
+    if (d.present) r &= readSlot(d);
+  }  // for-next each device
+  return (r);
+}  // of method read_bit()
+void DSFamily_Sim::depower(void) {
+  /*!
+    @brief      Stop driving the 1-Wire line, the simulated pull-up keeps parasitic devices powered
+  */
+}  // of method depower()
+void DSFamily_Sim::busActivity(DSFamily_SimDevice &d) {
+  /*!
+    @brief     Bring the conversion state of a device up to date before a slot
+    @details   A finished conversion is latched into the scratchpad. A parasitically powered device
+               loses its power during any slot, so a conversion which is still running is aborted
+               and the scratchpad keeps the previous value
+    @param[in] d Device to update
+  */
+  if (d.convEnd == 0 || d.stuckBusy) return;
+  if (DSHostMicros() >= d.convEnd) {
+    latchTemperature(d);
+    d.convEnd = 0;
+  } else if (d.parasitic) {
+    d.convEnd = 0;  // Lost power, conversion is aborted
+  }  // if-then-else conversion finished
+}  // of method busActivity()
+void DSFamily_Sim::latchTemperature(DSFamily_SimDevice &d) {
+  /*!
+    @brief     Store the temperature of a device in its scratchpad in the device's format
+    @details   The DS18S20 reports 0.5°C steps plus COUNT_REMAIN; the others report 1/16°C steps
+               with the bits below the configured resolution set to zero
+    @param[in] d Device to update
+  */
+  int16_t t = d.temperature;
+  if (d.rom[0] == SIM_DS18S20_FAMILY) {
+    int16_t whole = t & ~0xF;  // Truncate to full degrees, see datasheet for count remain
+    uint8_t frac  = t & 0xF;
+    if (frac > 12) whole += 16;
+    d.scratchpad[6] = whole + 12 - t;  // COUNT_REMAIN
+    t               = whole >> 3;      // 0.5°C units
+  } else {
+    t &= ~((1 << (3 - ((d.scratchpad[4] >> 5) & 3))) - 1);  // Undefined bits are zero
+  }  // if-then-else a DS18S20
+  d.scratchpad[0] = t & 0xFF;
+  d.scratchpad[1] = (uint16_t)t >> 8;
+  updateCrc(d);
+}  // of method latchTemperature()
+void DSFamily_Sim::romCommand(DSFamily_SimDevice &d, const uint8_t command) {
+  /*!
+    @brief     Process a ROM command received after a reset
+    @param[in] d       Device which received the command
+    @param[in] command ROM command byte
+  */
+  switch (command) {
+    case 0xF0: d.state = SIM_SEARCH; break;                         // Search ROM
+    case 0xEC: d.state = alarm(d) ? SIM_SEARCH : SIM_IDLE; break;  // Alarm search
+    case 0x55: d.state = SIM_MATCH; break;                          // Match ROM
+    case 0xCC: d.state = SIM_FUNCTION; break;                       // Skip ROM
+    case 0x33: d.state = SIM_READ_ROM; break;                       // Read ROM
+    default: d.state = SIM_IDLE;                                    // Unknown command
+  }                                                                 // of switch command
+}  // of method romCommand()
+void DSFamily_Sim::functionCommand(DSFamily_SimDevice &d, const uint8_t command) {
+  /*!
+    @brief     Process a function command received by a selected device
+    @param[in] d       Device which received the command
+    @param[in] command Function command byte
+  */
+  switch (command) {
+    case 0x44:  // Convert T
+      d.state   = SIM_CONVERTING;
+      d.convEnd = DSHostMicros() + (d.rom[0] == SIM_DS18S20_FAMILY
+                                        ? SIM_CONVERSION_MICROS << 3
+                                        : SIM_CONVERSION_MICROS << ((d.scratchpad[4] >> 5) & 3));
+      break;
+    case 0xBE:  // Read scratchpad
+      d.state   = SIM_READ_SCRATCHPAD;
+      d.corrupt = 0;
+      if (d.crcErrors) {
+        d.crcErrors--;
+        d.corrupt = 0x5A;  // Flip some bits of the CRC
+      }                    // if-then corrupt this read
+      break;
+    case 0x4E: d.state = SIM_WRITE_SCRATCHPAD; break;  // Write scratchpad
+    case 0x48:                                         // Copy scratchpad
+      memcpy(d.nv, &d.scratchpad[2], 3);
+      d.nvWrites++;
+      d.state = SIM_NV_BUSY;
+      break;
+    case 0xB8:  // Recall E2
+      memcpy(&d.scratchpad[2], d.nv, 3);
+      updateCrc(d);
+      d.state = SIM_NV_BUSY;
+      break;
+    case 0xB4: d.state = SIM_READ_POWER; break;  // Read power supply
+    default: d.state = SIM_IDLE;                 // Unknown command
+  }                                              // of switch command
+}  // of method functionCommand()
+void DSFamily_Sim::writeSlot(DSFamily_SimDevice &d, const uint8_t bit) {
+  /*!
+    @brief     Process a write slot seen by an attached device
+    @param[in] d   Device seeing the slot
+    @param[in] bit Bit written by the master
+  */
+  switch (d.state) {
+    case SIM_ROM_COMMAND:
+    case SIM_FUNCTION:
+      d.shift |= bit << d.bitCount;
+      if (++d.bitCount == 8) {
+        uint8_t command = d.shift;
+        bool    isRom   = d.state == SIM_ROM_COMMAND;
+        d.bitCount      = 0;
+        d.shift         = 0;
+        if (isRom)
+          romCommand(d, command);
+        else
+          functionCommand(d, command);
+      }  // if-then command complete
+      break;
+    case SIM_MATCH:
+      if (bit != ((d.rom[d.bitCount >> 3] >> (d.bitCount & 7)) & 1))
+        d.state = SIM_IDLE;  // Not this device
+      else if (++d.bitCount == 64) {
+        d.state    = SIM_FUNCTION;
+        d.bitCount = 0;
+      }  // if-then-else address matches
+      break;
+    case SIM_SEARCH:
+      if (d.bitCount % 3 == 2) {
+        uint8_t i = d.bitCount / 3;
+        if (bit != ((d.rom[i >> 3] >> (i & 7)) & 1))
+          d.state = SIM_IDLE;  // Master took the other branch
+        else if (++d.bitCount == 192) {
+          d.state    = SIM_FUNCTION;
+          d.bitCount = 0;
+        }  // if-then-else device remains selected
+      } else {
+        readSlot(d);  // A "1" written in a read phase is a read slot
+      }               // if-then-else direction bit
+      break;
+    case SIM_WRITE_SCRATCHPAD:
+      d.shift |= bit << (d.bitCount & 7);
+      if ((++d.bitCount & 7) == 0) {
+        uint8_t i = 2 + (d.bitCount >> 3) - 1;
+        if (i < 4 || d.rom[0] != SIM_DS18S20_FAMILY)
+          d.scratchpad[i] = i == 4 ? (d.shift & 0x60) | 0x1F : d.shift;  // Only R1/R0 writable
+        d.shift = 0;
+        updateCrc(d);
+        if (i == 4) d.state = SIM_IDLE;
+      }  // if-then byte complete
+      break;
+    default: break;  // All other states ignore writes
+  }                  // of switch state
+}  // of method writeSlot()
+uint8_t DSFamily_Sim::readSlot(DSFamily_SimDevice &d) {
+  /*!
+    @brief     Process a read slot seen by an attached device
+    @param[in] d Device seeing the slot
+    @return    Bit sent by the device, "1" when it leaves the line alone
+  */
+  uint8_t r = 1;
+  switch (d.state) {
+    case SIM_SEARCH: {
+      uint8_t i = d.bitCount / 3;
+      if (d.bitCount % 3 < 2) {
+        r = (d.rom[i >> 3] >> (i & 7)) & 1;   // Address bit
+        if (d.bitCount % 3 == 1) r ^= 1;      // followed by its complement
+        d.bitCount++;
+      }  // if-then read phase of the triplet
+      break;
+    }  // of search
+    case SIM_READ_ROM:
+      if (d.bitCount < 64) {
+        r = (d.rom[d.bitCount >> 3] >> (d.bitCount & 7)) & 1;
+        d.bitCount++;
+      }  // if-then still sending
+      break;
+    case SIM_READ_SCRATCHPAD:
+      if (d.bitCount < 72) {
+        uint8_t value = d.scratchpad[d.bitCount >> 3];
+        if (d.bitCount >= 64) value ^= d.corrupt;
+        r = (value >> (d.bitCount & 7)) & 1;
+        d.bitCount++;
+      }  // if-then still sending
+      break;
+    case SIM_READ_POWER: r = d.parasitic ? 0 : 1; break;
+    case SIM_CONVERTING: r = (!d.parasitic && d.convEnd) ? 0 : 1; break;
+    default: break;  // All other states leave the line high
+  }                  // of switch state
+  return (r);
+}  // of method readSlot()
+void DSFamily_Sim::updateCrc(DSFamily_SimDevice &d) {
+  /*!
+    @brief     Recompute the CRC byte of a device's scratchpad
+    @param[in] d Device to update
+  */
+  d.scratchpad[8] = crc8(d.scratchpad, 8);
+}  // of method updateCrc()
+bool DSFamily_Sim::alarm(const DSFamily_SimDevice &d) {
+  /*!
+    @brief     Check whether the last measured temperature is outside the TH/TL alarm limits
+    @param[in] d Device to check
+    @return    "true" if the device responds to an alarm search
+  */
+  int16_t t = (int16_t)((d.scratchpad[1] << 8) | d.scratchpad[0]);
+  t         = d.rom[0] == SIM_DS18S20_FAMILY ? t >> 1 : t >> 4;  // Full degrees
+  return (t >= (int8_t)d.scratchpad[2] || t <= (int8_t)d.scratchpad[3]);
+}  // of method alarm()
+#endif
@@ -0,0 +1,96 @@
+// clang-format off
+/*! @file DSFamily_Sim.h
+
+ @section DSFamily_Sim_intro_section Description
+
+Simulated 1-Wire network for native host builds of the DSFamily library. DSFamily_Sim is a
+DSFamily_Class whose transport - the reset(), write_bit(), read_bit() and depower() slot
+primitives - is implemented by a bit-level model of the attached devices instead of a pin, so that
+ScanForDevices(), the search algorithm and all read and configuration paths run unchanged.\n\n
+
+Each simulated device has a ROM address with a valid CRC, a 9 byte scratchpad with CRC, the TH, TL
+and configuration bytes in NV memory and a temperature which is latched into the scratchpad when a
+conversion finishes. Conversions take the resolution-dependent time of the real devices on the
+virtual clock of DSFamily_Host.h and powered devices hold the line low while converting. The
+commands SEARCH ROM, ALARM SEARCH, MATCH ROM, SKIP ROM, READ ROM, CONVERT T, READ SCRATCHPAD,
+WRITE SCRATCHPAD, COPY SCRATCHPAD, RECALL E2 and READ POWER SUPPLY are supported.\n\n
+
+Faults can be injected per device: a device can be removed from the bus, return a number of
+corrupted scratchpads, never finish its conversion, or be parasitically powered so that any bus
+activity during the conversion aborts it. The whole bus can be shorted to ground.\n\n
+
+The simulation is only compiled when ARDUINO is not defined.
+
+@section DSFamily_Sim_license GNU General Public License v3.0
+
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU
+General Public License as published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version. This program is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details. You should
+have received a copy of the GNU General Public License along with this program.  If not, see
+<http://www.gnu.org/licenses/>.
+*/
+// clang-format on
+#if !defined(ARDUINO) && !defined(DSFamily_Sim_h)
+  /** @brief  Guard code to prevent multiple definitions */
+  #define DSFamily_Sim_h
+  #include <vector>
+
+  #include "DSFamily.h"  // Include the DSFamily class definition
+/*!
+ * @brief   State of a single simulated device
+ */
+struct DSFamily_SimDevice {
+  uint8_t  rom[8];         ///< 64-bit ROM address including CRC
+  uint8_t  scratchpad[9];  ///< Scratchpad contents including CRC
+  uint8_t  nv[3];          ///< TH, TL and configuration in NV memory
+  int16_t  temperature;    ///< Temperature to report in 1/16°C
+  bool     present;        ///< Device is attached to the bus
+  bool     parasitic;      ///< Device is parasitically powered
+  bool     stuckBusy;      ///< Conversions never finish
+  uint8_t  crcErrors;      ///< Number of following scratchpad reads to corrupt
+  uint64_t convEnd;        ///< Virtual time when the conversion finishes, 0 when idle
+  uint8_t  state;          ///< Protocol state
+  uint16_t bitCount;       ///< Bits transferred in the current state
+  uint8_t  shift;          ///< Byte being received
+  uint8_t  corrupt;        ///< Mask applied to the CRC byte of the current scratchpad read
+  uint8_t  nvWrites;       ///< Number of COPY SCRATCHPAD commands received
+};
+/*!
+ * @class   DSFamily_Sim
+ * @brief   DSFamily_Class attached to a simulated 1-Wire network
+ */
+class DSFamily_Sim : public DSFamily_Class {
+ public:
+  DSFamily_Sim(const uint8_t ReserveRom = 0);
+  uint16_t            addDevice(const uint8_t family, const uint32_t serial,
+                                const bool parasitic = false);
+  void                setTemperature(const uint16_t index, const int16_t temperature);
+  void                setPresent(const uint16_t index, const bool present);
+  void                setCrcErrors(const uint16_t index, const uint8_t count);
+  void                setStuckBusy(const uint16_t index, const bool stuck);
+  void                setBusShort(const bool shorted);
+  DSFamily_SimDevice &device(const uint16_t index);
+  uint16_t            deviceCount();
+
+ protected:
+  uint8_t reset(void) override;
+  void    write_bit(uint8_t v) override;
+  uint8_t read_bit(void) override;
+  void    depower(void) override;
+
+ private:
+  std::vector<DSFamily_SimDevice> _Devices;           ///< The simulated devices
+  bool                            _BusShort = false;  ///< Line is shorted to ground
+
+  void    busActivity(DSFamily_SimDevice &d);
+  void    latchTemperature(DSFamily_SimDevice &d);
+  void    romCommand(DSFamily_SimDevice &d, const uint8_t command);
+  void    functionCommand(DSFamily_SimDevice &d, const uint8_t command);
+  void    writeSlot(DSFamily_SimDevice &d, const uint8_t bit);
+  uint8_t readSlot(DSFamily_SimDevice &d);
+  void    updateCrc(DSFamily_SimDevice &d);
+  bool    alarm(const DSFamily_SimDevice &d);
+};  // of DSFamily_Sim class definition
+#endif